@@ -37,4 +37,11 @@
 #define SOIL_SENSOR_VCC_PIN -1 // Not used unless defined
 #endif
 
+// Fast boot: no ROM log on deep sleep wakes and no Serial wait loop (Serial is
+// only waited for after a cold boot). Image validation on deep sleep wake is
+// skipped via custom_sdkconfig in platformio.ini.
+#ifndef FAST_BOOT
+#define FAST_BOOT 1
+#endif
+
 #endif // BOARD_CONFIG_H
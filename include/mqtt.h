@@ -19,4 +19,37 @@
 #define BATTERY_DISCHARGE_RATE_MQTT_TOPIC "node/sensor/%s/discharge_rate"
 #define BATTERY_DISCHARGE_RATE_CONFIG_MQTT_TOPIC "homeassistant/sensor/%s/discharge_rate/config"
 
+// diagnostic topics (previous wake's energy estimate, see EnergyModel)
+#define ENERGY_WAKE_MQTT_TOPIC "node/sensor/%s/energy_wake_uah"
+#define ENERGY_SLEEP_MQTT_TOPIC "node/sensor/%s/energy_sleep_uah"
+#define ENERGY_TOTAL_MQTT_TOPIC "node/sensor/%s/energy_total_mah"
+#define ENERGY_STAGES_MQTT_TOPIC "node/sensor/%s/energy_stages"
+
+// per-stage wakeup latency {"stage":[p50_ms,p95_ms,max_ms,samples],...}, every few wakes
+#define LIFECYCLE_LATENCY_MQTT_TOPIC "node/sensor/%s/lifecycle_latency"
+
+// boot phases {"setup":[this_wake_us,max_us],...}, with the latency histograms
+#define BOOT_TIMING_MQTT_TOPIC "node/sensor/%s/boot_timing"
+
+// peripheral time-to-ready {"soil_adc":[last_ms,max_ms,samples,timeouts],...}, with the latency histograms
+#define READINESS_MQTT_TOPIC "node/sensor/%s/readiness"
+
+// crash streak after abnormal resets / overrun wakes {"reason":"task_wdt","stage":"","streak":2,...}, once connectivity returns
+#define BOOT_GUARD_MQTT_TOPIC "node/sensor/%s/boot_guard"
+
+// retained wake slot assignment (0 .. SLEEP_SCHEDULER_SLOT_COUNT-1, e.g. "mac" for the MAC-derived slot), subscribed
+#define WAKE_SLOT_MQTT_TOPIC "node/sensor/%s/wake_slot"
+
+// clock state {"synced":true,"drift_ppm":-412.5,...}, with the latency histograms
+#define CLOCK_MQTT_TOPIC "node/sensor/%s/clock"
+
+// fleet-wide reference time (Unix seconds, not retained), subscribed as a fallback to SNTP
+#define TIME_MQTT_TOPIC "node/time"
+
+// radio profile and connect cost {"profile":"near","tx_dbm":8.5,"rssi":-48,...}, every wake
+#define RADIO_MQTT_TOPIC "node/sensor/%s/radio"
+
+// pre-sleep GPIO audit {"digest":"<crc32>","mismatch":[gpio,...]}, when it changes or finds a mismatch
+#define GPIO_AUDIT_MQTT_TOPIC "node/sensor/%s/gpio_audit"
+
 #endif // MQTT_H
\ No newline at end of file
@@ -16,10 +16,50 @@
 // For `c6`: 1380 works well with the SparkFun Soil Sensor submerged in water
 #define SOIL_CONFIG_DEFAULT_WET_VALUE 1550 // needs to be calibrated per sensor/per board: value should be slightly lower than the submerged in water/wet reading
 
+// Power-up readiness: the sensor is ready once successive raw ADC samples
+// differ by at most SOIL_SENSOR_SETTLE_TOLERANCE, or after the timeout (ms)
+#ifndef SOIL_SENSOR_SETTLE_TOLERANCE
+#define SOIL_SENSOR_SETTLE_TOLERANCE 32
+#endif
+
+#ifndef SOIL_SENSOR_READY_TIMEOUT_MS
+#define SOIL_SENSOR_READY_TIMEOUT_MS 500
+#endif
+
 // Pin controlling peripheral power (e.g., sensors VCC enable)
 // Can be overridden via PlatformIO build flags per environment.
 #ifndef PERIPHERAL_POWER_PIN
 #define PERIPHERAL_POWER_PIN 45
 #endif
 
+// Rail switching time after toggling PERIPHERAL_POWER_PIN (ms). Devices on the
+// rail are waited for individually (see lib/Readiness).
+#ifndef PERIPHERAL_POWER_SETTLE_MS
+#define PERIPHERAL_POWER_SETTLE_MS 10
+#endif
+
+// Sample-and-decide mode (see lib/SoilWake): short radio-less wakes sample the
+// soil and only wake the radio when moisture crosses a threshold, leaves the
+// delta band around the last report, or the upload interval (from the sleep
+// scheduler) expired. 0 = report on every wake.
+#ifndef SOIL_WAKE_SAMPLING
+#define SOIL_WAKE_SAMPLING 0
+#endif
+
+#ifndef SOIL_WAKE_SAMPLE_INTERVAL_S
+#define SOIL_WAKE_SAMPLE_INTERVAL_S (15 * 60)
+#endif
+
+#ifndef SOIL_WAKE_LOW_THRESHOLD_PCT
+#define SOIL_WAKE_LOW_THRESHOLD_PCT 30
+#endif
+
+#ifndef SOIL_WAKE_HIGH_THRESHOLD_PCT
+#define SOIL_WAKE_HIGH_THRESHOLD_PCT 70
+#endif
+
+#ifndef SOIL_WAKE_DELTA_BAND_PCT
+#define SOIL_WAKE_DELTA_BAND_PCT 10
+#endif
+
 #endif // SOIL_SENSOR_CONFIG_H
\ No newline at end of file
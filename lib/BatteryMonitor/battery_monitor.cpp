@@ -1,14 +1,32 @@
 #include "battery_monitor.h"
 #include "SparkFun_MAX1704x_Fuel_Gauge_Arduino_Library.h"
 #include <Wire.h>
+#include <readiness.h>
 
 // Configuration constants
-#define BATTERY_MONITOR_MAX_RETRIES 10
-#define BATTERY_MONITOR_RETRY_DELAY_MS 10
+#define BATTERY_MONITOR_READY_TIMEOUT_MS 550  // Fuel gauge answering on I2C after power-up
+#define BATTERY_MONITOR_VCELL_TIMEOUT_MS 1000 // First valid cell voltage / SOC estimate after reset
+#define BATTERY_MONITOR_MIN_VCELL 2.5f        // Below this VCELL is not a plausible reading
+#define BATTERY_MONITOR_MAX_VCELL 5.0f
 
 SFE_MAX1704X lipo(MAX1704X_MAX17048); // Create a MAX17048
 bool is_started = false;
 
+static bool fuel_gauge_answering(void *context)
+{
+    (void)context;
+    return lipo.begin(Wire);
+}
+
+// VCELL and SOC registers read back zero until the gauge's first conversion
+static bool cell_voltage_valid(void *context)
+{
+    (void)context;
+    float voltage = lipo.getVoltage();
+    return !isnan(voltage) && voltage >= BATTERY_MONITOR_MIN_VCELL && voltage <= BATTERY_MONITOR_MAX_VCELL &&
+           lipo.getSOC() > 0.0f;
+}
+
 bool battery_monitor_start(void *context)
 {
     // Context parameter reserved for future use (e.g., I2C config)
@@ -25,22 +43,18 @@ bool battery_monitor_start(void *context)
         return false;
     }
 
-    // Start the MAX17048 sensor with retry logic
-    for (int attempt = 0; attempt < BATTERY_MONITOR_MAX_RETRIES; attempt++)
+    // Start the MAX17048 sensor as soon as it answers after power-up
+    if (readiness_wait(READINESS_FUEL_GAUGE, fuel_gauge_answering, NULL, BATTERY_MONITOR_READY_TIMEOUT_MS))
     {
-        if (lipo.begin(Wire))
-        {
-            is_started = true;
-            battery_monitor_reset();
-            return true;
-        }
-        delay(BATTERY_MONITOR_RETRY_DELAY_MS * (attempt + 1)); // Exponential back-off
+        is_started = true;
+        battery_monitor_reset();
+        return true;
     }
 
     is_started = false;
     Serial.print(F("Could not find a valid MAX17048 sensor after "));
-    Serial.print(BATTERY_MONITOR_MAX_RETRIES);
-    Serial.println(F(" attempts, check wiring!"));
+    Serial.print(BATTERY_MONITOR_READY_TIMEOUT_MS);
+    Serial.println(F("ms, check wiring!"));
     return false;
 }
 
@@ -65,7 +79,8 @@ void battery_monitor_reset()
         resetIndicator = lipo.isReset(); // Read the RI flag
         Serial.println(resetIndicator);  // Print the RI
     }
-    delay(1000); // let the IC settle after reset
+    // Let the IC settle after reset: wait for its first valid cell reading
+    readiness_wait(READINESS_CELL_VOLTAGE, cell_voltage_valid, NULL, BATTERY_MONITOR_VCELL_TIMEOUT_MS);
 }
 
 void battery_monitor_stop(void *context)
@@ -1,183 +1,962 @@
 #include "board_lifecycle.h"
 #include <Arduino.h>
 #include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp_rtc_time.h>
+#include <rtc_store.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include <freertos/semphr.h>
 
-// Maximum number of callbacks that can be registered for each lifecycle phase
-#define MAX_LIFECYCLE_CALLBACKS 8
+// Installed lifecycle table (index 0 → N-1 is a valid sequential wakeup order)
+static const board_lifecycle_stage *lifecycle_stages = NULL;
+static uint8_t lifecycle_stage_count = 0;
 
-// Internal structure to store callback and its context
+// Per-execution results of the wakeup callbacks (written by the wakeup tasks)
+static uint32_t wakeup_callback_time_ms[MAX_LIFECYCLE_STAGES];
+static board_lifecycle_result wakeup_callback_result[MAX_LIFECYCLE_STAGES];
+
+// Completion bits of the running wakeup graph (bit N set once stage N completed)
+static EventGroupHandle_t wakeup_events = NULL;
+
+// Running wakeup tasks; a handle is cleared (under task_lock) by whichever side
+// finishes the stage first: the task itself, or the engine abandoning it
+static TaskHandle_t wakeup_task_handles[MAX_LIFECYCLE_STAGES];
+static volatile bool wakeup_callback_running[MAX_LIFECYCLE_STAGES];
+static volatile bool wakeup_callback_abandoned[MAX_LIFECYCLE_STAGES];
+static TaskHandle_t volatile wakeup_callback_task[MAX_LIFECYCLE_STAGES]; // Task inside the callback, NULL once returned
+static uint32_t wakeup_callback_start_ms[MAX_LIFECYCLE_STAGES];
+static portMUX_TYPE task_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Per-stage CPU clock: applied under clock_mutex so the last change always wins
+static board_lifecycle_clock_handler clock_handler = NULL;
+static SemaphoreHandle_t clock_mutex = NULL;
+static bool clock_applied = false;
+static uint32_t applied_clock_request = BOARD_LIFECYCLE_DEFAULT_CLOCK;
+static uint32_t applied_clock_mhz = 0;
+static uint32_t wakeup_callback_cpu_mhz[MAX_LIFECYCLE_STAGES];
+
+// Awake budget (0 = disabled) and when it runs out (ms since boot; later once renewed)
+static uint32_t awake_budget_ms = 0;
+static uint32_t budget_deadline_ms = 0;
+static uint64_t budget_overrun_sleep_seconds = 0;
+static esp_timer_handle_t budget_timer = NULL;
+static volatile bool budget_expired = false;
+
+// Duration passed to board_lifecycle_enter_sleep() (or until the target of board_lifecycle_enter_sleep_until())
+static uint64_t requested_sleep_seconds = 0;
+static board_lifecycle_sleep_timer_handler sleep_timer_handler = NULL;
+
+// Installed wake profiles and the stages selected for this wake
+static const board_lifecycle_profile *lifecycle_profiles = NULL;
+static uint8_t lifecycle_profile_count = 0;
+static board_lifecycle_profile_selector lifecycle_profile_selector = NULL;
+static board_lifecycle_deps active_stages = BOARD_LIFECYCLE_ALL_STAGES(MAX_LIFECYCLE_STAGES);
+static const char *active_profile_name = "all";
+static board_lifecycle_wake_info wake_info = {};
+
+// Wake history surviving deep sleep (RTC store slot)
 typedef struct
 {
-    board_lifecycle_callback callback;
-    void *context;
-} board_lifecycle_callback_entry;
+    uint32_t boot_count;
+    uint32_t stage_overruns;
+    uint32_t budget_overruns;
+    bool last_wakeup_failed;
+    bool last_wake_overran;
+    uint8_t last_overrun_stage;
+    uint8_t latency_stage_count; // Table size the histograms belong to
+    uint16_t latency_counts[MAX_LIFECYCLE_STAGES][BOARD_LIFECYCLE_LATENCY_BUCKETS];
+    uint32_t latency_max_ms[MAX_LIFECYCLE_STAGES];
+    uint64_t sleep_end_rtc_us; // RTC time the last deep sleep's timer expires, 0 if none
+} lifecycle_rtc_state;
+
+#define LIFECYCLE_RTC_STATE_VERSION 2
+
+static lifecycle_rtc_state *rtc = NULL;
 
-// Static storage for wakeup callbacks (FIFO execution: index 0 → N-1)
-static board_lifecycle_callback_entry wakeup_callbacks[MAX_LIFECYCLE_CALLBACKS];
-static uint8_t wakeup_callback_count = 0;
+static lifecycle_rtc_state *rtc_state(void)
+{
+    if (rtc == NULL)
+    {
+        bool fresh = false;
+        rtc = rtc_store_claim<lifecycle_rtc_state, RTC_SLOT_LIFECYCLE>(LIFECYCLE_RTC_STATE_VERSION, &fresh);
+        if (fresh)
+        {
+            rtc->last_overrun_stage = BOARD_LIFECYCLE_NO_STAGE;
+        }
+    }
+    return rtc;
+}
 
-// Static storage for sleep callbacks (LIFO execution: index N-1 → 0)
-static board_lifecycle_callback_entry sleep_callbacks[MAX_LIFECYCLE_CALLBACKS];
-static uint8_t sleep_callback_count = 0;
+// Per-stage latency histograms surviving deep sleep. Counts are halved when a
+// bucket saturates, so old wakes fade out instead of the histogram freezing.
+static const uint32_t latency_bucket_upper_ms[BOARD_LIFECYCLE_LATENCY_BUCKETS] = {
+    10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, UINT32_MAX};
 
 // Metrics tracking
 static board_lifecycle_metrics metrics = {0};
 
-bool board_lifecycle_register_wakeup(board_lifecycle_callback callback, void *context)
+void board_lifecycle_init(const board_lifecycle_stage *stages, uint8_t count)
 {
-    if (callback == NULL)
+    if (stages == NULL || count > MAX_LIFECYCLE_STAGES)
     {
-        Serial.println(F("BoardLifecycle: WARNING - Attempted to register NULL wakeup callback"));
-        return false;
+        Serial.println(F("BoardLifecycle: ERROR - Invalid lifecycle table, lifecycle disabled"));
+        count = 0;
+    }
+
+    lifecycle_stages = stages;
+    lifecycle_stage_count = count;
+
+    metrics.wakeup_callbacks_registered = 0;
+    metrics.sleep_callbacks_registered = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        metrics.wakeup_callbacks_registered += (stages[i].wakeup != NULL);
+        metrics.sleep_callbacks_registered += (stages[i].sleep != NULL);
+    }
+}
+
+void board_lifecycle_set_profiles(const board_lifecycle_profile *profiles, uint8_t count,
+                                  board_lifecycle_profile_selector selector)
+{
+    if (profiles == NULL || count == 0 || selector == NULL)
+    {
+        Serial.println(F("BoardLifecycle: WARNING - Invalid profiles, every stage will run"));
+        profiles = NULL;
+        count = 0;
+        selector = NULL;
+    }
+
+    lifecycle_profiles = profiles;
+    lifecycle_profile_count = count;
+    lifecycle_profile_selector = selector;
+}
+
+// Read the wake cause/reset reason and pick the stages to run for this wake
+static void select_wake_profile(void)
+{
+    rtc_state()->boot_count++;
+
+    wake_info.wakeup_cause = esp_sleep_get_wakeup_cause();
+    wake_info.reset_reason = esp_reset_reason();
+    wake_info.boot_count = rtc_state()->boot_count;
+    wake_info.last_wakeup_failed = rtc_state()->last_wakeup_failed;
+    wake_info.last_wake_overran = rtc_state()->last_wake_overran;
+    rtc_state()->last_wake_overran = false;
+
+    // The RTC timer runs through sleep and boot; esp_timer starts with the app
+    wake_info.wake_to_app_us = 0;
+    uint64_t sleep_end_us = rtc_state()->sleep_end_rtc_us;
+    if (wake_info.wakeup_cause == ESP_SLEEP_WAKEUP_TIMER && sleep_end_us != 0)
+    {
+        int64_t app_start_us = (int64_t)esp_rtc_get_time_us() - esp_timer_get_time();
+        if (app_start_us > (int64_t)sleep_end_us)
+        {
+            wake_info.wake_to_app_us = (uint32_t)(app_start_us - (int64_t)sleep_end_us);
+        }
+    }
+    rtc_state()->sleep_end_rtc_us = 0;
+
+    // Sealed at claim, changed just now: reseal so a crash in this wake does not discard the slot
+    rtc_store_commit_slot(RTC_SLOT_LIFECYCLE);
+
+    active_stages = BOARD_LIFECYCLE_ALL_STAGES(MAX_LIFECYCLE_STAGES);
+    active_profile_name = "all";
+
+    if (lifecycle_profile_selector != NULL)
+    {
+        uint8_t profile = lifecycle_profile_selector(&wake_info);
+        if (profile < lifecycle_profile_count)
+        {
+            active_stages = lifecycle_profiles[profile].stages;
+            active_profile_name = lifecycle_profiles[profile].name;
+        }
+        else
+        {
+            Serial.println(F("BoardLifecycle: WARNING - Selector returned unknown profile, running every stage"));
+        }
     }
 
-    if (wakeup_callback_count >= MAX_LIFECYCLE_CALLBACKS)
+    Serial.print(F("BoardLifecycle: Wake cause "));
+    Serial.print((int)wake_info.wakeup_cause);
+    Serial.print(F(", reset reason "));
+    Serial.print((int)wake_info.reset_reason);
+    Serial.print(F(", boot #"));
+    Serial.print(wake_info.boot_count);
+    Serial.print(F(" -> profile '"));
+    Serial.print(active_profile_name);
+    Serial.println(F("'"));
+}
+
+bool board_lifecycle_stage_active(int8_t index)
+{
+    if (index < 0 || index >= lifecycle_stage_count)
     {
-        Serial.print(F("BoardLifecycle: ERROR - Wakeup callback array full (max "));
-        Serial.print(MAX_LIFECYCLE_CALLBACKS);
-        Serial.println(F("), callback not registered"));
         return false;
     }
+    return (active_stages & BOARD_LIFECYCLE_DEPENDS_ON(index)) != 0;
+}
 
-    wakeup_callbacks[wakeup_callback_count].callback = callback;
-    wakeup_callbacks[wakeup_callback_count].context = context;
-    wakeup_callback_count++;
+bool board_lifecycle_last_wake_overran(uint8_t *stage)
+{
+    // The RTC flag is moved into wake_info (and cleared) once the wake profile is selected
+    bool overran = (wake_info.boot_count != 0) ? wake_info.last_wake_overran : rtc_state()->last_wake_overran;
+    if (stage != NULL)
+    {
+        *stage = overran ? rtc_state()->last_overrun_stage : BOARD_LIFECYCLE_NO_STAGE;
+    }
+    return overran;
+}
 
-    metrics.wakeup_callbacks_registered = wakeup_callback_count;
+board_lifecycle_wake_info board_lifecycle_get_wake_info(void)
+{
+    return wake_info;
+}
 
-    Serial.print(F("BoardLifecycle: Registered wakeup callback #"));
-    Serial.println(wakeup_callback_count);
+const char *board_lifecycle_get_profile_name(void)
+{
+    return active_profile_name;
+}
 
+// True if every dependency of a wakeup callback succeeded
+// (results are written before the completion bit is set, so they are visible here)
+static bool wakeup_dependencies_succeeded(uint8_t index)
+{
+    board_lifecycle_deps depends_on = lifecycle_stages[index].depends_on;
+    for (uint8_t dep = 0; dep < index; dep++)
+    {
+        if ((depends_on & BOARD_LIFECYCLE_DEPENDS_ON(dep)) && wakeup_callback_result[dep] != BOARD_LIFECYCLE_RESULT_OK)
+        {
+            return false;
+        }
+    }
     return true;
 }
 
-bool board_lifecycle_register_sleep(board_lifecycle_callback callback, void *context)
+void board_lifecycle_set_clock_handler(board_lifecycle_clock_handler handler)
 {
-    if (callback == NULL)
+    if (clock_mutex == NULL)
     {
-        Serial.println(F("BoardLifecycle: WARNING - Attempted to register NULL sleep callback"));
-        return false;
+        clock_mutex = xSemaphoreCreateMutex();
+    }
+    clock_handler = (clock_mutex != NULL) ? handler : NULL;
+}
+
+// Apply the clock the running stages ask for: the highest request wins, and a
+// running stage on the default clock keeps the default
+static void update_cpu_clock(void)
+{
+    if (clock_handler == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(clock_mutex, portMAX_DELAY);
+
+    bool any_running = false;
+    bool wants_default = false;
+    uint32_t request = 0;
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        if (!wakeup_callback_running[i])
+        {
+            continue;
+        }
+        any_running = true;
+        if (lifecycle_stages[i].cpu_mhz == BOARD_LIFECYCLE_DEFAULT_CLOCK)
+        {
+            wants_default = true;
+        }
+        else if (lifecycle_stages[i].cpu_mhz > request)
+        {
+            request = lifecycle_stages[i].cpu_mhz;
+        }
+    }
+    if (!any_running || wants_default)
+    {
+        request = BOARD_LIFECYCLE_DEFAULT_CLOCK;
+    }
+
+    if (!clock_applied || request != applied_clock_request)
+    {
+        applied_clock_mhz = clock_handler(request);
+        applied_clock_request = request;
+        clock_applied = true;
+    }
+
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        if (wakeup_callback_running[i] && applied_clock_mhz > wakeup_callback_cpu_mhz[i])
+        {
+            wakeup_callback_cpu_mhz[i] = applied_clock_mhz;
+        }
+    }
+
+    xSemaphoreGive(clock_mutex);
+}
+
+uint32_t board_lifecycle_get_stage_cpu_mhz(int8_t index)
+{
+    if (index < 0 || index >= lifecycle_stage_count)
+    {
+        return 0;
+    }
+    return wakeup_callback_cpu_mhz[index];
+}
+
+// Run a single wakeup callback (or skip it if a dependency failed) and record its result
+static void run_wakeup_callback(uint8_t index)
+{
+    const board_lifecycle_stage *stage = &lifecycle_stages[index];
+    wakeup_callback_time_ms[index] = 0;
+    wakeup_callback_cpu_mhz[index] = 0;
+
+    if (!board_lifecycle_stage_active(index))
+    {
+        // Not part of this wake's profile
+        wakeup_callback_result[index] = BOARD_LIFECYCLE_RESULT_INACTIVE;
+        return;
+    }
+
+    if (!wakeup_dependencies_succeeded(index))
+    {
+        Serial.print(F("BoardLifecycle: ["));
+        Serial.print(stage->name);
+        Serial.println(F("] SKIPPED (dependency failed)"));
+        wakeup_callback_result[index] = BOARD_LIFECYCLE_RESULT_SKIPPED;
+        return;
+    }
+
+    if (stage->wakeup == NULL)
+    {
+        // Sleep-only stage: nothing to do, dependents may proceed
+        wakeup_callback_result[index] = BOARD_LIFECYCLE_RESULT_OK;
+        return;
+    }
+
+    uint32_t callback_start = millis();
+    wakeup_callback_start_ms[index] = callback_start;
+    wakeup_callback_abandoned[index] = false;
+    wakeup_callback_task[index] = xTaskGetCurrentTaskHandle();
+    wakeup_callback_running[index] = true;
+    update_cpu_clock();
+
+    // Execute the callback
+    bool ok = stage->wakeup(stage->context);
+
+    taskENTER_CRITICAL(&task_lock);
+    bool abandoned = wakeup_callback_abandoned[index];
+    wakeup_callback_task[index] = NULL;
+    taskEXIT_CRITICAL(&task_lock);
+
+    if (abandoned)
+    {
+        // The engine already recorded the timeout and moved on
+        Serial.print(F("BoardLifecycle: ["));
+        Serial.print(stage->name);
+        Serial.print(F("] returned "));
+        Serial.print(millis() - callback_start);
+        Serial.println(F("ms after its start, past its deadline"));
+        return;
+    }
+
+    wakeup_callback_running[index] = false;
+    wakeup_callback_time_ms[index] = millis() - callback_start;
+    wakeup_callback_result[index] = ok ? BOARD_LIFECYCLE_RESULT_OK : BOARD_LIFECYCLE_RESULT_FAILED;
+    update_cpu_clock();
+
+    Serial.print(F("BoardLifecycle: ["));
+    Serial.print(stage->name);
+    Serial.print(ok ? F("] completed in ") : F("] FAILED after "));
+    Serial.print(wakeup_callback_time_ms[index]);
+    if (wakeup_callback_cpu_mhz[index] != 0)
+    {
+        Serial.print(F("ms at up to "));
+        Serial.print(wakeup_callback_cpu_mhz[index]);
+        Serial.print(F("MHz"));
+    }
+    else
+    {
+        Serial.print(F("ms"));
+    }
+    Serial.print(F(" (core "));
+    Serial.print(xPortGetCoreID());
+    Serial.println(F(")"));
+}
+
+// Block until all dependencies of a stage have completed
+static void wait_for_wakeup_dependencies(uint8_t index)
+{
+    board_lifecycle_deps depends_on = lifecycle_stages[index].depends_on;
+    if (depends_on != BOARD_LIFECYCLE_NO_DEPS)
+    {
+        xEventGroupWaitBits(wakeup_events, depends_on, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+}
+
+// Atomically take ownership of a running wakeup task (NULL if it already finished)
+static TaskHandle_t take_wakeup_task(uint8_t index)
+{
+    taskENTER_CRITICAL(&task_lock);
+    TaskHandle_t handle = wakeup_task_handles[index];
+    wakeup_task_handles[index] = NULL;
+    taskEXIT_CRITICAL(&task_lock);
+    return handle;
+}
+
+// Atomically take over a running stage from its task, which keeps running until
+// its callback returns but no longer reports a result (false if it already finished)
+static bool abandon_wakeup_task(uint8_t index)
+{
+    taskENTER_CRITICAL(&task_lock);
+    bool running = (wakeup_task_handles[index] != NULL);
+    wakeup_task_handles[index] = NULL;
+    if (running)
+    {
+        wakeup_callback_abandoned[index] = true;
+    }
+    taskEXIT_CRITICAL(&task_lock);
+    return running;
+}
+
+uint32_t board_lifecycle_stage_remaining_ms(void)
+{
+    uint32_t remaining_ms = board_lifecycle_budget_remaining_ms();
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        if (wakeup_callback_task[i] != self)
+        {
+            continue;
+        }
+        if (wakeup_callback_abandoned[i])
+        {
+            return 0;
+        }
+
+        uint32_t deadline_ms = lifecycle_stages[i].deadline_ms;
+        if (deadline_ms != BOARD_LIFECYCLE_NO_DEADLINE)
+        {
+            uint32_t elapsed_ms = millis() - wakeup_callback_start_ms[i];
+            uint32_t stage_ms = (elapsed_ms < deadline_ms) ? deadline_ms - elapsed_ms : 0;
+            if (stage_ms < remaining_ms)
+            {
+                remaining_ms = stage_ms;
+            }
+        }
+        break;
+    }
+    return remaining_ms;
+}
+
+// FreeRTOS task body: wait for prerequisites, run the callback, signal completion
+static void wakeup_task(void *param)
+{
+    uint8_t index = (uint8_t)(uintptr_t)param;
+
+    wait_for_wakeup_dependencies(index);
+    run_wakeup_callback(index);
+
+    // If the engine abandoned us in the meantime it already signalled completion
+    if (take_wakeup_task(index) != NULL)
+    {
+        xEventGroupSetBits(wakeup_events, BOARD_LIFECYCLE_DEPENDS_ON(index));
+    }
+
+    vTaskDelete(NULL);
+}
+
+// Record a deadline or budget overrun in RTC memory
+static void record_stage_overrun(uint8_t index)
+{
+    metrics.wakeup_overruns++;
+    rtc_state()->stage_overruns++;
+    rtc_state()->last_overrun_stage = index;
+    rtc_state()->last_wake_overran = true;
+    rtc_store_commit_slot(RTC_SLOT_LIFECYCLE); // BootGuard needs it if the hang ends in a reset
+}
+
+// Abandon running stages that exceeded their deadline (or all of them once the
+// budget expired); dependents will be skipped
+static void abandon_overrun_stages(void)
+{
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        uint32_t deadline_ms = lifecycle_stages[i].deadline_ms;
+        bool overran = budget_expired || (deadline_ms != BOARD_LIFECYCLE_NO_DEADLINE &&
+                                          now - wakeup_callback_start_ms[i] > deadline_ms);
+        if (!wakeup_callback_running[i] || !overran || !abandon_wakeup_task(i))
+        {
+            continue; // Not running, in time, or finished just now
+        }
+
+        wakeup_callback_running[i] = false;
+        wakeup_callback_time_ms[i] = now - wakeup_callback_start_ms[i];
+        wakeup_callback_result[i] = BOARD_LIFECYCLE_RESULT_TIMEOUT;
+        record_stage_overrun(i);
+
+        Serial.println(F(""));
+        Serial.print(F("BoardLifecycle: ["));
+        Serial.print(lifecycle_stages[i].name);
+        Serial.print(F("] ABANDONED after "));
+        Serial.print(wakeup_callback_time_ms[i]);
+        Serial.println(budget_expired ? F("ms, awake budget exceeded") : F("ms, deadline exceeded"));
+
+        xEventGroupSetBits(wakeup_events, BOARD_LIFECYCLE_DEPENDS_ON(i));
+        update_cpu_clock();
+    }
+}
+
+// True while an abandoned stage's callback has not returned yet
+static bool abandoned_stage_running(uint8_t index)
+{
+    return wakeup_callback_abandoned[index] && wakeup_callback_task[index] != NULL;
+}
+
+// Give abandoned stages time to notice (their remaining time is 0) and return
+static void wait_for_abandoned_stages(void)
+{
+    uint32_t start = millis();
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        while (abandoned_stage_running(i) && millis() - start < BOARD_LIFECYCLE_CANCEL_GRACE_MS)
+        {
+            vTaskDelay(pdMS_TO_TICKS(BOARD_LIFECYCLE_DEADLINE_POLL_MS));
+        }
+        if (abandoned_stage_running(i))
+        {
+            Serial.print(F("BoardLifecycle: WARNING - ["));
+            Serial.print(lifecycle_stages[i].name);
+            Serial.println(F("] still has not returned"));
+        }
+    }
+}
+
+// Run the deferred stages (sleep-only, or without a task of their own) whose
+// dependencies have all completed, in table order so chains complete in one pass
+static void run_ready_deferred_stages(board_lifecycle_deps *deferred)
+{
+    for (uint8_t i = 0; i < lifecycle_stage_count && *deferred != 0; i++)
+    {
+        board_lifecycle_deps depends_on = lifecycle_stages[i].depends_on;
+        if (!(*deferred & BOARD_LIFECYCLE_DEPENDS_ON(i)) ||
+            (xEventGroupGetBits(wakeup_events) & depends_on) != depends_on)
+        {
+            continue;
+        }
+
+        *deferred &= ~BOARD_LIFECYCLE_DEPENDS_ON(i);
+        run_wakeup_callback(i);
+        xEventGroupSetBits(wakeup_events, BOARD_LIFECYCLE_DEPENDS_ON(i));
     }
+}
 
-    if (sleep_callback_count >= MAX_LIFECYCLE_CALLBACKS)
+// Execute the wakeup graph on one task per stage with a wakeup callback. The
+// calling task never waits on a dependency without a timeout, so it keeps
+// enforcing deadlines whatever the profile leaves out.
+static bool run_wakeup_graph(void)
+{
+    wakeup_events = xEventGroupCreate();
+    if (wakeup_events == NULL)
     {
-        Serial.print(F("BoardLifecycle: ERROR - Sleep callback array full (max "));
-        Serial.print(MAX_LIFECYCLE_CALLBACKS);
-        Serial.println(F("), callback not registered"));
+        Serial.println(F("BoardLifecycle: WARNING - Could not create event group, falling back to sequential wakeup"));
         return false;
     }
 
-    sleep_callbacks[sleep_callback_count].callback = callback;
-    sleep_callbacks[sleep_callback_count].context = context;
-    sleep_callback_count++;
+    UBaseType_t priority = uxTaskPriorityGet(NULL);
+    board_lifecycle_deps all_done = 0;
+    board_lifecycle_deps deferred = 0; // Run on this task once their dependencies completed
+
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        all_done |= BOARD_LIFECYCLE_DEPENDS_ON(i);
+
+        if (!board_lifecycle_stage_active(i))
+        {
+            // Not part of this wake's profile: INACTIVE right away, dependents skip on it
+            run_wakeup_callback(i);
+            xEventGroupSetBits(wakeup_events, BOARD_LIFECYCLE_DEPENDS_ON(i));
+            continue;
+        }
+
+        if (lifecycle_stages[i].wakeup == NULL)
+        {
+            // Sleep-only stage: no task needed, completes once its dependencies have
+            deferred |= BOARD_LIFECYCLE_DEPENDS_ON(i);
+            continue;
+        }
+
+        // Spread tasks across cores on dual-core parts (S3), let the scheduler pick on single-core (C6)
+        BaseType_t core = (portNUM_PROCESSORS > 1) ? (BaseType_t)(i % portNUM_PROCESSORS) : tskNO_AFFINITY;
+
+        char task_name[16];
+        snprintf(task_name, sizeof(task_name), "lc_%s", lifecycle_stages[i].name);
+
+        // The handle is stored before the task can run, so the task always finds it
+        if (xTaskCreatePinnedToCore(wakeup_task, task_name, BOARD_LIFECYCLE_TASK_STACK_SIZE,
+                                    (void *)(uintptr_t)i, priority, &wakeup_task_handles[i], core) != pdPASS)
+        {
+            wakeup_task_handles[i] = NULL;
+
+            // Run it on the calling task instead, once its dependencies have completed
+            Serial.print(F("BoardLifecycle: WARNING - Could not create task for stage "));
+            Serial.print(lifecycle_stages[i].name);
+            Serial.println(F(", running inline"));
+            deferred |= BOARD_LIFECYCLE_DEPENDS_ON(i);
+        }
+    }
+
+    // Wait for every stage, checking deadlines while stages are still running
+    while (all_done != 0)
+    {
+        run_ready_deferred_stages(&deferred);
 
-    metrics.sleep_callbacks_registered = sleep_callback_count;
+        EventBits_t done = xEventGroupWaitBits(wakeup_events, all_done, pdFALSE, pdTRUE,
+                                               pdMS_TO_TICKS(BOARD_LIFECYCLE_DEADLINE_POLL_MS));
+        if ((done & all_done) == all_done)
+        {
+            break;
+        }
+        abandon_overrun_stages();
+    }
 
-    Serial.print(F("BoardLifecycle: Registered sleep callback #"));
-    Serial.println(sleep_callback_count);
+    // Abandoned tasks never touch the event group again
+    vEventGroupDelete(wakeup_events);
+    wakeup_events = NULL;
 
+    wait_for_abandoned_stages();
     return true;
 }
 
+static void budget_timer_callback(void *arg)
+{
+    (void)arg;
+
+    if (!budget_expired)
+    {
+        // Stages now see no time left and the wakeup graph abandons whatever still
+        // runs; the application heads for board_lifecycle_enter_sleep() on its own
+        budget_expired = true;
+        rtc_state()->budget_overruns++;
+        rtc_state()->last_wake_overran = true;
+        rtc_store_commit_slot(RTC_SLOT_LIFECYCLE);
+        esp_timer_start_once(budget_timer, BOARD_LIFECYCLE_BUDGET_GRACE_MS * 1000ULL);
+        return;
+    }
+
+    // The application did not reach sleep within the grace period: sleep without the
+    // sleep callbacks rather than run them on whatever state it is stuck in
+    rtc_store_commit();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    esp_sleep_enable_timer_wakeup(budget_overrun_sleep_seconds * 1000000ULL);
+    esp_deep_sleep_start();
+}
+
+void board_lifecycle_set_awake_budget(uint32_t budget_ms, uint64_t overrun_sleep_seconds)
+{
+    awake_budget_ms = budget_ms;
+    budget_deadline_ms = budget_ms; // The budget counts from boot
+    budget_overrun_sleep_seconds = overrun_sleep_seconds;
+}
+
+uint32_t board_lifecycle_budget_remaining_ms(void)
+{
+    if (awake_budget_ms == 0)
+    {
+        return UINT32_MAX;
+    }
+    if (budget_expired)
+    {
+        return 0;
+    }
+
+    uint32_t awake_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    return (awake_ms < budget_deadline_ms) ? budget_deadline_ms - awake_ms : 0;
+}
+
+// Arm the awake budget timer (budget counts from boot)
+static void arm_awake_budget(void)
+{
+    if (awake_budget_ms == 0)
+    {
+        return;
+    }
+
+    if (budget_timer == NULL)
+    {
+        esp_timer_create_args_t args = {};
+        args.callback = budget_timer_callback;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "lc_budget";
+
+        if (esp_timer_create(&args, &budget_timer) != ESP_OK)
+        {
+            Serial.println(F("BoardLifecycle: WARNING - Could not create awake budget timer, budget not enforced"));
+            budget_timer = NULL;
+            return;
+        }
+    }
+
+    uint32_t remaining_ms = board_lifecycle_budget_remaining_ms();
+    esp_timer_start_once(budget_timer, (remaining_ms > 0 ? remaining_ms : 1) * 1000ULL);
+
+    Serial.print(F("BoardLifecycle: Awake budget armed, "));
+    Serial.print(remaining_ms);
+    Serial.println(F("ms remaining"));
+}
+
+void board_lifecycle_renew_awake_budget(uint32_t remaining_ms)
+{
+    if (awake_budget_ms == 0 || budget_expired)
+    {
+        return;
+    }
+
+    budget_deadline_ms = (uint32_t)(esp_timer_get_time() / 1000) + remaining_ms;
+    if (budget_timer != NULL)
+    {
+        esp_timer_stop(budget_timer);
+        arm_awake_budget();
+    }
+}
+
+// Add one wakeup callback time to a stage's histogram
+static void record_stage_latency(uint8_t index, uint32_t ms)
+{
+    uint8_t bucket = 0;
+    while (ms > latency_bucket_upper_ms[bucket])
+    {
+        bucket++;
+    }
+
+    uint16_t *counts = rtc_state()->latency_counts[index];
+    if (counts[bucket] == UINT16_MAX)
+    {
+        for (uint8_t b = 0; b < BOARD_LIFECYCLE_LATENCY_BUCKETS; b++)
+        {
+            counts[b] /= 2;
+        }
+    }
+    counts[bucket]++;
+
+    if (ms > rtc_state()->latency_max_ms[index])
+    {
+        rtc_state()->latency_max_ms[index] = ms;
+    }
+}
+
+static void record_wakeup_latencies(void)
+{
+    // A different table would misattribute the histograms
+    if (rtc_state()->latency_stage_count != lifecycle_stage_count)
+    {
+        board_lifecycle_reset_latency();
+        rtc_state()->latency_stage_count = lifecycle_stage_count;
+    }
+
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        board_lifecycle_result result = wakeup_callback_result[i];
+        if (lifecycle_stages[i].wakeup == NULL || result == BOARD_LIFECYCLE_RESULT_SKIPPED ||
+            result == BOARD_LIFECYCLE_RESULT_INACTIVE)
+        {
+            continue;
+        }
+        record_stage_latency(i, wakeup_callback_time_ms[i]);
+    }
+}
+
 board_lifecycle_status board_lifecycle_wakeup(void)
 {
     metrics.wakeup_failures = 0;
+    metrics.wakeup_skipped = 0;
+    metrics.wakeup_overruns = 0;
     uint32_t start_time = millis();
 
-    Serial.println(F("BoardLifecycle: ===== Starting wakeup sequence (FIFO order) ====="));
-    Serial.print(F("BoardLifecycle: Executing "));
-    Serial.print(wakeup_callback_count);
-    Serial.println(F(" wakeup callbacks"));
+    arm_awake_budget();
 
-    // Execute callbacks in FIFO order (0 → N-1)
-    for (uint8_t i = 0; i < wakeup_callback_count; i++)
-    {
-        board_lifecycle_callback_entry *entry = &wakeup_callbacks[i];
+    Serial.println(F("BoardLifecycle: ===== Starting wakeup sequence (dependency order) ====="));
+    select_wake_profile();
 
-        Serial.print(F("BoardLifecycle: ["));
-        Serial.print(i + 1);
-        Serial.print(F("/"));
-        Serial.print(wakeup_callback_count);
-        Serial.print(F("] Executing wakeup callback..."));
+    bool ran_graph = false;
+#if BOARD_LIFECYCLE_PARALLEL_WAKEUP
+    ran_graph = run_wakeup_graph();
+#endif
 
-        if (entry->callback != NULL)
+    if (!ran_graph)
+    {
+        // Table order always satisfies the dependencies
+        for (uint8_t i = 0; i < lifecycle_stage_count; i++)
         {
-            uint32_t callback_start = millis();
-
-            // Execute the callback
-            entry->callback(entry->context);
+            run_wakeup_callback(i);
+        }
+    }
 
-            uint32_t callback_time = millis() - callback_start;
+    bool critical_failure = false;
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        if (wakeup_callback_result[i] == BOARD_LIFECYCLE_RESULT_OK ||
+            wakeup_callback_result[i] == BOARD_LIFECYCLE_RESULT_INACTIVE)
+        {
+            continue;
+        }
 
-            Serial.print(F(" completed in "));
-            Serial.print(callback_time);
-            Serial.println(F("ms"));
+        if (wakeup_callback_result[i] == BOARD_LIFECYCLE_RESULT_SKIPPED)
+        {
+            metrics.wakeup_skipped++;
         }
         else
         {
-            Serial.println(F(" SKIPPED (NULL callback)"));
-            metrics.wakeup_failures++;
+            metrics.wakeup_failures++; // Includes deadline overruns
+        }
+
+        if (lifecycle_stages[i].flags & BOARD_LIFECYCLE_STAGE_CRITICAL)
+        {
+            critical_failure = true;
         }
     }
 
     metrics.last_wakeup_time_ms = millis() - start_time;
+    rtc_state()->last_wakeup_failed = critical_failure;
+    record_wakeup_latencies();
+    rtc_store_commit(); // Keep this wake's history even if the rest of it crashes
 
     Serial.print(F("BoardLifecycle: Wakeup sequence complete in "));
     Serial.print(metrics.last_wakeup_time_ms);
     Serial.println(F("ms"));
     Serial.println(F("BoardLifecycle: ====================================="));
 
-    if (metrics.wakeup_failures > 0)
+    if (critical_failure)
+    {
+        return BOARD_LIFECYCLE_TOTAL_FAILURE;
+    }
+
+    if (metrics.wakeup_failures > 0 || metrics.wakeup_skipped > 0)
     {
-        if (metrics.wakeup_failures >= wakeup_callback_count)
-        {
-            return BOARD_LIFECYCLE_TOTAL_FAILURE;
-        }
         return BOARD_LIFECYCLE_PARTIAL_FAILURE;
     }
 
     return BOARD_LIFECYCLE_SUCCESS;
 }
 
+board_lifecycle_result board_lifecycle_get_wakeup_result(int8_t index)
+{
+    if (index < 0 || index >= lifecycle_stage_count)
+    {
+        return BOARD_LIFECYCLE_RESULT_SKIPPED;
+    }
+    return wakeup_callback_result[index];
+}
+
+uint32_t board_lifecycle_get_wakeup_time_ms(int8_t index)
+{
+    if (index < 0 || index >= lifecycle_stage_count)
+    {
+        return 0;
+    }
+    return wakeup_callback_time_ms[index];
+}
+
+uint64_t board_lifecycle_get_sleep_seconds(void)
+{
+    return requested_sleep_seconds;
+}
+
+// Upper bound of the bucket holding the given percentile
+static uint32_t latency_percentile_ms(const uint16_t *counts, uint32_t samples, uint8_t percent)
+{
+    uint32_t rank = (samples * percent + 99) / 100; // 1-based, rounded up
+    uint32_t seen = 0;
+
+    for (uint8_t b = 0; b < BOARD_LIFECYCLE_LATENCY_BUCKETS; b++)
+    {
+        seen += counts[b];
+        if (seen >= rank)
+        {
+            return latency_bucket_upper_ms[b];
+        }
+    }
+    return latency_bucket_upper_ms[BOARD_LIFECYCLE_LATENCY_BUCKETS - 1];
+}
+
+bool board_lifecycle_get_stage_latency(int8_t index, board_lifecycle_latency *latency)
+{
+    if (index < 0 || index >= lifecycle_stage_count || latency == NULL)
+    {
+        return false;
+    }
+
+    const uint16_t *counts = rtc_state()->latency_counts[index];
+    latency->samples = 0;
+    for (uint8_t b = 0; b < BOARD_LIFECYCLE_LATENCY_BUCKETS; b++)
+    {
+        latency->samples += counts[b];
+    }
+
+    latency->max_ms = rtc_state()->latency_max_ms[index];
+    if (latency->samples == 0)
+    {
+        latency->p50_ms = 0;
+        latency->p95_ms = 0;
+        return true;
+    }
+
+    // Never report more than was observed (bounds the open-ended top bucket)
+    uint32_t p50_ms = latency_percentile_ms(counts, latency->samples, 50);
+    uint32_t p95_ms = latency_percentile_ms(counts, latency->samples, 95);
+    latency->p50_ms = (p50_ms < latency->max_ms) ? p50_ms : latency->max_ms;
+    latency->p95_ms = (p95_ms < latency->max_ms) ? p95_ms : latency->max_ms;
+    return true;
+}
+
+void board_lifecycle_reset_latency(void)
+{
+    memset(rtc_state()->latency_counts, 0, sizeof(rtc_state()->latency_counts));
+    memset(rtc_state()->latency_max_ms, 0, sizeof(rtc_state()->latency_max_ms));
+}
+
 board_lifecycle_status board_lifecycle_prep_sleep(void)
 {
-    metrics.sleep_failures = 0;
     uint32_t start_time = millis();
 
-    Serial.println(F("BoardLifecycle: ===== Starting sleep preparation (LIFO order) ====="));
-    Serial.print(F("BoardLifecycle: Executing "));
-    Serial.print(sleep_callback_count);
-    Serial.println(F(" sleep callbacks"));
+    Serial.println(F("BoardLifecycle: ===== Starting sleep preparation (reverse table order) ====="));
 
-    // Execute callbacks in LIFO order (N-1 → 0)
-    for (int8_t i = sleep_callback_count - 1; i >= 0; i--)
+    // Execute sleep callbacks in reverse wake order (N-1 → 0)
+    for (int8_t i = lifecycle_stage_count - 1; i >= 0; i--)
     {
-        board_lifecycle_callback_entry *entry = &sleep_callbacks[i];
+        const board_lifecycle_stage *stage = &lifecycle_stages[i];
+
+        if (stage->sleep == NULL || !board_lifecycle_stage_active(i))
+        {
+            continue; // Wakeup-only stage, or not part of this wake's profile
+        }
+
+        if (abandoned_stage_running(i))
+        {
+            Serial.print(F("BoardLifecycle: ["));
+            Serial.print(stage->name);
+            Serial.println(F("] Wakeup callback still running, sleep callback skipped"));
+            continue;
+        }
 
         Serial.print(F("BoardLifecycle: ["));
-        Serial.print(sleep_callback_count - i);
-        Serial.print(F("/"));
-        Serial.print(sleep_callback_count);
+        Serial.print(stage->name);
         Serial.print(F("] Executing sleep callback..."));
 
-        if (entry->callback != NULL)
-        {
-            uint32_t callback_start = millis();
+        uint32_t callback_start = millis();
 
-            // Execute the callback
-            entry->callback(entry->context);
+        // Execute the callback
+        stage->sleep(stage->context);
 
-            uint32_t callback_time = millis() - callback_start;
+        uint32_t callback_time = millis() - callback_start;
 
-            Serial.print(F(" completed in "));
-            Serial.print(callback_time);
-            Serial.println(F("ms"));
-        }
-        else
-        {
-            Serial.println(F(" SKIPPED (NULL callback)"));
-            metrics.sleep_failures++;
-        }
+        Serial.print(F(" completed in "));
+        Serial.print(callback_time);
+        Serial.println(F("ms"));
     }
 
     metrics.last_sleep_prep_time_ms = millis() - start_time;
@@ -187,39 +966,93 @@ board_lifecycle_status board_lifecycle_prep_sleep(void)
     Serial.println(F("ms"));
     Serial.println(F("BoardLifecycle: ====================================="));
 
-    if (metrics.sleep_failures > 0)
+    return BOARD_LIFECYCLE_SUCCESS;
+}
+
+// Run the sleep callbacks, then sleep for sleep_us from now or, if wake_rtc_us is
+// set, until the RTC timer reaches it (the callbacks' run time is then taken out)
+static void enter_sleep(uint64_t sleep_us, uint64_t wake_rtc_us)
+{
+    // Voluntary sleep: disarm the awake budget (a forced sleep keeps the grace timer armed)
+    if (budget_timer != NULL && !budget_expired)
+    {
+        esp_timer_stop(budget_timer);
+    }
+
+    requested_sleep_seconds = (sleep_us + 500000ULL) / 1000000ULL;
+
+    if (budget_expired)
     {
-        if (metrics.sleep_failures >= sleep_callback_count)
+        Serial.print(F("BoardLifecycle: Awake budget of "));
+        Serial.print(awake_budget_ms);
+        if (budget_deadline_ms != awake_budget_ms)
         {
-            return BOARD_LIFECYCLE_TOTAL_FAILURE;
+            Serial.print(F("ms (renewed until "));
+            Serial.print(budget_deadline_ms);
+            Serial.print(F("ms after boot)"));
         }
-        return BOARD_LIFECYCLE_PARTIAL_FAILURE;
+        else
+        {
+            Serial.print(F("ms"));
+        }
+        Serial.println(F(" exceeded, sleeping"));
     }
 
-    return BOARD_LIFECYCLE_SUCCESS;
-}
-
-void board_lifecycle_enter_sleep(uint64_t seconds)
-{
     // Execute all sleep preparation callbacks first
     board_lifecycle_prep_sleep();
 
+    // Timer interval from here on, as late as possible
+    uint64_t now_rtc_us = esp_rtc_get_time_us();
+    if (wake_rtc_us != 0)
+    {
+        sleep_us = (wake_rtc_us > now_rtc_us + BOARD_LIFECYCLE_MIN_SLEEP_US) ? wake_rtc_us - now_rtc_us
+                                                                             : BOARD_LIFECYCLE_MIN_SLEEP_US;
+    }
+
     Serial.print(F("BoardLifecycle: Entering deep sleep for "));
-    Serial.print(seconds);
+    Serial.print((double)sleep_us / 1e6, 3);
     Serial.println(F(" seconds..."));
 
     // Disable all wakeup sources first
     esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
 
     // Enable timer wakeup
-    esp_sleep_enable_timer_wakeup(seconds * 1000000ULL);
+    uint64_t timer_us = sleep_us;
+    if (sleep_timer_handler != NULL)
+    {
+        timer_us = sleep_timer_handler(sleep_us);
+    }
+    esp_sleep_enable_timer_wakeup(timer_us);
+    rtc_state()->sleep_end_rtc_us = now_rtc_us + sleep_us;
+
+    // Seal cross-wake state written during this wake and the sleep callbacks
+    rtc_store_commit();
 
     // Enter deep sleep (this function does not return)
     esp_deep_sleep_start();
 }
 
+void board_lifecycle_enter_sleep(uint64_t seconds)
+{
+    enter_sleep(seconds * 1000000ULL, 0);
+}
+
+void board_lifecycle_enter_sleep_until(uint64_t wake_rtc_us)
+{
+    uint64_t now_rtc_us = esp_rtc_get_time_us();
+    enter_sleep((wake_rtc_us > now_rtc_us) ? wake_rtc_us - now_rtc_us : 0, wake_rtc_us);
+}
+
+void board_lifecycle_set_sleep_timer_handler(board_lifecycle_sleep_timer_handler handler)
+{
+    sleep_timer_handler = handler;
+}
+
 board_lifecycle_metrics board_lifecycle_get_metrics(void)
 {
+    metrics.total_stage_overruns = rtc_state()->stage_overruns;
+    metrics.total_budget_overruns = rtc_state()->budget_overruns;
+    metrics.last_overrun_stage = rtc_state()->last_overrun_stage;
     return metrics;
 }
 
@@ -227,20 +1060,50 @@ void board_lifecycle_print_metrics(void)
 {
     Serial.println(F(""));
     Serial.println(F("BoardLifecycle: ===== Lifecycle Metrics ====="));
-    Serial.print(F("  Wakeup callbacks registered: "));
+    Serial.print(F("  Lifecycle stages:            "));
+    Serial.println(lifecycle_stage_count);
+    Serial.print(F("  Active profile:              "));
+    Serial.println(active_profile_name);
+    Serial.print(F("  Wakeup callbacks:            "));
     Serial.println(metrics.wakeup_callbacks_registered);
-    Serial.print(F("  Sleep callbacks registered:  "));
+    Serial.print(F("  Sleep callbacks:             "));
     Serial.println(metrics.sleep_callbacks_registered);
     Serial.print(F("  Wakeup failures (last run):  "));
     Serial.println(metrics.wakeup_failures);
-    Serial.print(F("  Sleep failures (last run):   "));
-    Serial.println(metrics.sleep_failures);
+    Serial.print(F("  Wakeup skipped (last run):   "));
+    Serial.println(metrics.wakeup_skipped);
+    Serial.print(F("  Deadline overruns (last run):"));
+    Serial.println(metrics.wakeup_overruns);
+    Serial.print(F("  Stage overruns (total):      "));
+    Serial.println(rtc_state()->stage_overruns);
+    Serial.print(F("  Budget overruns (total):     "));
+    Serial.println(rtc_state()->budget_overruns);
     Serial.print(F("  Last wakeup time:            "));
     Serial.print(metrics.last_wakeup_time_ms);
     Serial.println(F("ms"));
     Serial.print(F("  Last sleep prep time:        "));
     Serial.print(metrics.last_sleep_prep_time_ms);
     Serial.println(F("ms"));
+
+    for (uint8_t i = 0; i < lifecycle_stage_count; i++)
+    {
+        board_lifecycle_latency latency;
+        if (!board_lifecycle_get_stage_latency(i, &latency) || latency.samples == 0)
+        {
+            continue;
+        }
+        Serial.print(F("  Latency ["));
+        Serial.print(lifecycle_stages[i].name);
+        Serial.print(F("] p50/p95/max: "));
+        Serial.print(latency.p50_ms);
+        Serial.print(F("/"));
+        Serial.print(latency.p95_ms);
+        Serial.print(F("/"));
+        Serial.print(latency.max_ms);
+        Serial.print(F("ms over "));
+        Serial.print(latency.samples);
+        Serial.println(F(" wakes"));
+    }
     Serial.println(F("BoardLifecycle: ============================="));
     Serial.println(F(""));
 }
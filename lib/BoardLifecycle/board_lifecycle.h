@@ -1,106 +1,545 @@
 #ifndef BOARD_LIFECYCLE_H
 #define BOARD_LIFECYCLE_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
 
 /**
  * Board Lifecycle Library for ESP32 Soil Sensor
  *
- * Manages board wakeup and sleep lifecycle with ordered callback execution.
- * Wakeup callbacks execute in FIFO order (registration order: 1,2,3).
- * Sleep callbacks execute in LIFO order (reverse order: 3,2,1).
+ * Manages board wakeup and sleep lifecycle from a single, compile-time stage table.
+ * Each stage pairs a wakeup callback with the sleep callback that undoes it.
+ * Wakeup callbacks execute in dependency order (table order: 1,2,3).
+ * Sleep callbacks execute in reverse table order (3,2,1), so sleep order is
+ * always derived from wake order and never has to be maintained by hand.
  *
  * This allows peripherals to be powered on and initialized in dependency order,
  * then shut down in reverse order to properly release resources.
  *
  * Example:
- *   Register: peripheral_power_on, power_mgmt_post_wakeup, battery_monitor_start
- *   Wakeup:   1→2→3 (peripheral power first, then cleanup holds, then battery)
- *   Sleep:    3→2→1 (battery first, then power mgmt, then peripheral power off)
+ *   Table:  power_mgmt, peripheral_power, battery
+ *   Wakeup: 1→2→3 (release holds first, then peripheral power, then battery)
+ *   Sleep:  3→2→1 (battery first, then peripheral power off, then power mgmt)
+ *
+ * Stages declare explicit dependencies on earlier stages. The wakeup sequence
+ * runs as a dependency graph: every stage gets its own FreeRTOS task which
+ * blocks until all of its prerequisites have completed, so independent work
+ * (e.g. WiFi association vs. peripheral power-up and fuel gauge settling)
+ * overlaps instead of queueing. On dual-core parts the tasks are spread across
+ * both cores.
+ *
+ * Example:
+ *   static constexpr board_lifecycle_stage stages[] = {
+ *       {"power", peripheral_power_on, peripheral_power_off, NULL, BOARD_LIFECYCLE_NO_DEPS, OPTIONAL},
+ *       {"wifi", wifi_conn_start, wifi_conn_stop, &wifi, BOARD_LIFECYCLE_NO_DEPS, CRITICAL},
+ *       {"mqtt", pubsub_connect, pubsub_stop, &mqtt, BOARD_LIFECYCLE_DEPENDS_ON(1), CRITICAL},
+ *   };
+ *   BOARD_LIFECYCLE_CHECK_TABLE(stages);
+ *   Wakeup: peripheral power and WiFi start together, MQTT starts once WiFi succeeded
+ *           (and is skipped entirely if WiFi gave up)
+ *
+ * Profiles select which stages a given wake runs. On wakeup the engine reads the
+ * wake cause and reset reason and asks a selector callback to pick a profile,
+ * e.g. "sample only" (no radio) for a sensor-triggered wake vs. "full cycle" for
+ * the regular timer wake. Stages outside the active profile run neither their
+ * wakeup nor their sleep callback. Without profiles every stage runs.
+ *
+ * Awake time is bounded twice: each stage may declare a deadline, and a global
+ * awake budget (esp_timer) bounds the whole wake. Cancellation is cooperative:
+ * callbacks bound their own waits and retries by board_lifecycle_stage_remaining_ms().
+ * A stage still running at its deadline is abandoned, never deleted: it counts
+ * as failed, its dependents are skipped and its task is left to return on its
+ * own (a task killed inside a driver call would leave driver locks held). Once
+ * the budget expires every stage sees no time left and the application is
+ * expected to reach board_lifecycle_enter_sleep(); if it has not within a grace
+ * period the board sleeps without the sleep callbacks. Overruns are recorded in
+ * RTC memory.
+ *
+ * Stages may also ask for a CPU clock. While wakeup callbacks run, the engine
+ * applies the highest clock asked for by any running stage (a stage on the
+ * default clock keeps the default) through a clock handler, and the default
+ * once wakeup is complete. Most of a wake waits on hardware, not the CPU.
  */
 
+// Maximum number of stages in a lifecycle table (checked at compile time)
+#define MAX_LIFECYCLE_STAGES 16
+
+// Set BOARD_LIFECYCLE_PARALLEL_WAKEUP=0 to force strictly sequential wakeup
+// (table order), e.g. when debugging interleaved serial output.
+#ifndef BOARD_LIFECYCLE_PARALLEL_WAKEUP
+#define BOARD_LIFECYCLE_PARALLEL_WAKEUP 1
+#endif
+
+// Stack size (bytes) of each wakeup task when running the dependency graph
+#ifndef BOARD_LIFECYCLE_TASK_STACK_SIZE
+#define BOARD_LIFECYCLE_TASK_STACK_SIZE 8192
+#endif
+
+// How often running stages are checked against their deadlines (milliseconds)
+#ifndef BOARD_LIFECYCLE_DEADLINE_POLL_MS
+#define BOARD_LIFECYCLE_DEADLINE_POLL_MS 50
+#endif
+
+// How long the engine waits for abandoned stages to return (milliseconds)
+#ifndef BOARD_LIFECYCLE_CANCEL_GRACE_MS
+#define BOARD_LIFECYCLE_CANCEL_GRACE_MS 2000
+#endif
+
+// Time after a budget overrun before sleeping without the sleep callbacks (milliseconds)
+#ifndef BOARD_LIFECYCLE_BUDGET_GRACE_MS
+#define BOARD_LIFECYCLE_BUDGET_GRACE_MS 5000
+#endif
+
+// Shortest sleep of board_lifecycle_enter_sleep_until() when its target has already passed (us)
+#ifndef BOARD_LIFECYCLE_MIN_SLEEP_US
+#define BOARD_LIFECYCLE_MIN_SLEEP_US 100000ULL
+#endif
+
+// Latency histogram buckets per stage (upper bounds in board_lifecycle.cpp)
+#define BOARD_LIFECYCLE_LATENCY_BUCKETS 12
+
+// Marker for "no deadline" / "no stage" / "default CPU clock" values
+#define BOARD_LIFECYCLE_NO_DEADLINE 0
+#define BOARD_LIFECYCLE_NO_STAGE 0xFF
+#define BOARD_LIFECYCLE_DEFAULT_CLOCK 0
+
 /**
  * Lifecycle operation status codes.
  */
 typedef enum
 {
     BOARD_LIFECYCLE_SUCCESS = 0,        // All callbacks executed successfully
-    BOARD_LIFECYCLE_PARTIAL_FAILURE = 1, // Some callbacks failed but execution continued
-    BOARD_LIFECYCLE_TOTAL_FAILURE = 2    // Critical failure during lifecycle execution
+    BOARD_LIFECYCLE_PARTIAL_FAILURE = 1, // Some optional callbacks failed or were skipped
+    BOARD_LIFECYCLE_TOTAL_FAILURE = 2    // A critical callback failed or was skipped
 } board_lifecycle_status;
 
 /**
- * Lifecycle callback function signature.
- * Callbacks receive an optional context pointer.
+ * Outcome of a single wakeup callback in the last wakeup execution.
+ */
+typedef enum
+{
+    BOARD_LIFECYCLE_RESULT_OK = 0,       // Callback ran and reported success (or stage has no wakeup callback)
+    BOARD_LIFECYCLE_RESULT_FAILED = 1,   // Callback ran and reported failure
+    BOARD_LIFECYCLE_RESULT_SKIPPED = 2,  // Callback not run because a dependency did not succeed
+    BOARD_LIFECYCLE_RESULT_INACTIVE = 3, // Stage not part of the active profile (not a failure)
+    BOARD_LIFECYCLE_RESULT_TIMEOUT = 4   // Callback overran its deadline and was abandoned (counts as failure)
+} board_lifecycle_result;
+
+/**
+ * Stage flags.
+ * A failed or skipped critical stage makes the whole wakeup a total failure;
+ * optional stages only degrade it to a partial failure.
+ */
+typedef enum
+{
+    BOARD_LIFECYCLE_STAGE_OPTIONAL = 0x00,
+    BOARD_LIFECYCLE_STAGE_CRITICAL = 0x01
+} board_lifecycle_stage_flags;
+
+/**
+ * Wakeup callback function signature.
+ * Callbacks receive an optional context pointer and report whether they succeeded.
+ * Stages that depend on a failed stage are skipped.
+ *
+ * @param context User-defined context data (can be NULL)
+ * @return true on success, false on failure
+ */
+typedef bool (*board_lifecycle_wakeup_callback)(void *context);
+
+/**
+ * Sleep callback function signature.
+ * Sleep callbacks always run (they must release resources regardless of how far
+ * wakeup got), so they do not report a status.
  *
  * @param context User-defined context data (can be NULL)
  */
 typedef void (*board_lifecycle_callback)(void *context);
 
+/**
+ * Bitmask of stages a stage depends on.
+ * Bit N refers to the stage at index N of the lifecycle table.
+ */
+typedef uint32_t board_lifecycle_deps;
+
+#define BOARD_LIFECYCLE_NO_DEPS ((board_lifecycle_deps)0)
+#define BOARD_LIFECYCLE_DEPENDS_ON(index) ((board_lifecycle_deps)1 << (index))
+
+/**
+ * One entry of the lifecycle table.
+ * Either callback may be NULL (wakeup-only or sleep-only stage).
+ */
+typedef struct
+{
+    const char *name;                       // Short stage name used in logs
+    board_lifecycle_wakeup_callback wakeup; // Runs during wakeup, in dependency order
+    board_lifecycle_callback sleep;         // Runs during sleep prep, in reverse table order
+    void *context;                          // Passed to both callbacks (can be NULL)
+    board_lifecycle_deps depends_on;        // Earlier stages that must succeed first
+    uint8_t flags;                          // board_lifecycle_stage_flags
+    uint32_t deadline_ms;                   // Max wakeup callback run time, BOARD_LIFECYCLE_NO_DEADLINE for none
+    uint16_t cpu_mhz;                       // CPU clock while the wakeup callback runs, BOARD_LIFECYCLE_DEFAULT_CLOCK for the default
+} board_lifecycle_stage;
+
+/**
+ * Compile-time validation of a lifecycle table: checks capacity and that every
+ * stage only depends on earlier stages (which keeps the graph acyclic and makes
+ * table order a valid sequential wakeup order).
+ */
+template <size_t N>
+constexpr bool board_lifecycle_table_fits(const board_lifecycle_stage (&)[N])
+{
+    return N > 0 && N <= MAX_LIFECYCLE_STAGES;
+}
+
+template <size_t N>
+constexpr bool board_lifecycle_table_ordered(const board_lifecycle_stage (&stages)[N])
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        if ((stages[i].depends_on >> i) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * A wake profile: the subset of stages a wake runs.
+ * Profiles must be closed under dependencies (checked at compile time).
+ */
+typedef struct
+{
+    const char *name;            // Short profile name used in logs
+    board_lifecycle_deps stages; // Mask of stages to run, built with BOARD_LIFECYCLE_DEPENDS_ON()
+} board_lifecycle_profile;
+
+#define BOARD_LIFECYCLE_ALL_STAGES(count) ((board_lifecycle_deps)((1ULL << (count)) - 1))
+
+/**
+ * Why the board is awake, passed to the profile selector.
+ */
+typedef struct
+{
+    esp_sleep_wakeup_cause_t wakeup_cause; // ESP_SLEEP_WAKEUP_UNDEFINED on cold boot/reset
+    esp_reset_reason_t reset_reason;       // ESP_RST_DEEPSLEEP for wakes from deep sleep
+    uint32_t boot_count;                   // Wakes since power-on (kept in RTC memory)
+    bool last_wakeup_failed;               // Previous wake ended in BOARD_LIFECYCLE_TOTAL_FAILURE
+    bool last_wake_overran;                // Previous wake was cut short by a deadline or the awake budget
+    uint32_t wake_to_app_us;               // Sleep timer expiry to app start (ROM + bootloader), 0 if unknown
+} board_lifecycle_wake_info;
+
+/**
+ * Profile selector: returns the index of the profile to run for this wake.
+ * Out-of-range indices run every stage.
+ */
+typedef uint8_t (*board_lifecycle_profile_selector)(const board_lifecycle_wake_info *info);
+
+template <size_t N, size_t P>
+constexpr bool board_lifecycle_profiles_closed(const board_lifecycle_stage (&stages)[N],
+                                               const board_lifecycle_profile (&profiles)[P])
+{
+    for (size_t p = 0; p < P; p++)
+    {
+        if ((profiles[p].stages >> N) != 0)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < N; i++)
+        {
+            bool active = (profiles[p].stages >> i) & 1;
+            if (active && (stages[i].depends_on & ~profiles[p].stages) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#define BOARD_LIFECYCLE_CHECK_PROFILES(stages, profiles) \
+    static_assert(board_lifecycle_profiles_closed(stages, profiles), "Lifecycle profile misses a stage dependency or names an unknown stage")
+
+#define BOARD_LIFECYCLE_CHECK_TABLE(stages)                                                      \
+    static_assert(board_lifecycle_table_fits(stages), "Lifecycle table exceeds MAX_LIFECYCLE_STAGES"); \
+    static_assert(board_lifecycle_table_ordered(stages), "Lifecycle stage depends on itself or a later stage")
+
 /**
  * Metrics tracked during lifecycle operations.
  * Useful for debugging performance issues and identifying slow callbacks.
  */
 typedef struct
 {
-    uint8_t wakeup_callbacks_registered; // Number of registered wakeup callbacks
-    uint8_t sleep_callbacks_registered;  // Number of registered sleep callbacks
+    uint8_t wakeup_callbacks_registered; // Number of stages with a wakeup callback
+    uint8_t sleep_callbacks_registered;  // Number of stages with a sleep callback
     uint8_t wakeup_failures;             // Count of failed wakeup callbacks in last execution
-    uint8_t sleep_failures;              // Count of failed sleep callbacks in last execution
+    uint8_t wakeup_skipped;              // Count of wakeup callbacks skipped due to failed dependencies
+    uint8_t wakeup_overruns;             // Count of wakeup callbacks abandoned at their deadline
     uint32_t last_wakeup_time_ms;        // Total time for last wakeup execution (milliseconds)
     uint32_t last_sleep_prep_time_ms;    // Total time for last sleep prep execution (milliseconds)
+    uint32_t total_stage_overruns;       // Stage deadline overruns since power-on (RTC)
+    uint32_t total_budget_overruns;      // Awake budget overruns since power-on (RTC)
+    uint8_t last_overrun_stage;          // Stage of the most recent deadline overrun, BOARD_LIFECYCLE_NO_STAGE if none (RTC)
 } board_lifecycle_metrics;
 
 /**
- * Register a callback to execute during wakeup.
- * Callbacks execute in FIFO order (registration order).
+ * Install the lifecycle table. No copying and no per-stage registration work:
+ * the engine iterates the (flash-resident) table directly.
+ * Prefer the array overload, which validates the table at compile time.
+ *
+ * @param stages Lifecycle table (must outlive the lifecycle, typically static constexpr)
+ * @param count Number of stages in the table
+ */
+void board_lifecycle_init(const board_lifecycle_stage *stages, uint8_t count);
+
+template <size_t N>
+inline void board_lifecycle_init(const board_lifecycle_stage (&stages)[N])
+{
+    static_assert(N > 0 && N <= MAX_LIFECYCLE_STAGES, "Lifecycle table exceeds MAX_LIFECYCLE_STAGES");
+    board_lifecycle_init(stages, (uint8_t)N);
+}
+
+/**
+ * Install wake profiles and the selector that picks one per wake.
+ * Must be called after board_lifecycle_init() and before board_lifecycle_wakeup().
+ *
+ * @param profiles Profile table (must outlive the lifecycle, typically static constexpr)
+ * @param count Number of profiles
+ * @param selector Picks the profile index for this wake (must not be NULL)
+ */
+void board_lifecycle_set_profiles(const board_lifecycle_profile *profiles, uint8_t count,
+                                  board_lifecycle_profile_selector selector);
+
+template <size_t P>
+inline void board_lifecycle_set_profiles(const board_lifecycle_profile (&profiles)[P],
+                                         board_lifecycle_profile_selector selector)
+{
+    static_assert(P > 0 && P <= 255, "Invalid number of lifecycle profiles");
+    board_lifecycle_set_profiles(profiles, (uint8_t)P, selector);
+}
+
+/**
+ * Clock handler: switches the CPU clock.
  *
- * @param callback Function pointer to callback (must not be NULL)
- * @param context Optional context pointer (can be NULL)
- * @return true if registered successfully, false if array is full or callback is NULL
+ * @param cpu_mhz Requested clock, BOARD_LIFECYCLE_DEFAULT_CLOCK for the default
+ * @return Clock actually applied (MHz); handlers may clamp the request
  */
-bool board_lifecycle_register_wakeup(board_lifecycle_callback callback, void *context);
+typedef uint32_t (*board_lifecycle_clock_handler)(uint32_t cpu_mhz);
 
 /**
- * Register a callback to execute during sleep preparation.
- * Callbacks execute in LIFO order (reverse registration order).
+ * Install the handler that applies the stages' CPU clocks during wakeup.
+ * Without a handler the cpu_mhz of every stage is ignored.
  *
- * @param callback Function pointer to callback (must not be NULL)
- * @param context Optional context pointer (can be NULL)
- * @return true if registered successfully, false if array is full or callback is NULL
+ * @param handler Clock handler (NULL disables per-stage clocks)
  */
-bool board_lifecycle_register_sleep(board_lifecycle_callback callback, void *context);
+void board_lifecycle_set_clock_handler(board_lifecycle_clock_handler handler);
 
 /**
- * Execute all registered wakeup callbacks in FIFO order.
+ * Get the highest CPU clock applied while a stage's wakeup callback ran
+ * (stages overlapping a default-clock stage run at the default clock).
+ *
+ * @param index Index of the stage in the lifecycle table
+ * @return Clock in MHz, 0 if unknown (no clock handler, not run or invalid index)
+ */
+uint32_t board_lifecycle_get_stage_cpu_mhz(int8_t index);
+
+/**
+ * Sleep timer handler: turns the requested sleep into the timer interval to
+ * program (e.g. a wake stub splitting a long sleep into shorter intervals).
+ *
+ * @param sleep_us Requested sleep until the next full wake
+ * @return Timer interval for the first wake
+ */
+typedef uint64_t (*board_lifecycle_sleep_timer_handler)(uint64_t sleep_us);
+
+/**
+ * Install the sleep timer handler used by board_lifecycle_enter_sleep().
+ *
+ * @param handler Sleep timer handler (NULL programs the requested sleep as is)
+ */
+void board_lifecycle_set_sleep_timer_handler(board_lifecycle_sleep_timer_handler handler);
+
+/**
+ * Bound the total awake time of a wake.
+ * The budget counts from boot and is armed by board_lifecycle_wakeup(). When it
+ * expires the overrun is recorded and running stages see no time left; the
+ * application should stop its work (board_lifecycle_budget_remaining_ms() is 0)
+ * and call board_lifecycle_enter_sleep(). If it has not within
+ * BOARD_LIFECYCLE_BUDGET_GRACE_MS, the board sleeps for overrun_sleep_seconds
+ * without running the sleep callbacks.
+ *
+ * @param budget_ms Maximum awake time per wake (0 disables the budget)
+ * @param overrun_sleep_seconds Sleep duration when the grace period runs out
+ */
+void board_lifecycle_set_awake_budget(uint32_t budget_ms, uint64_t overrun_sleep_seconds);
+
+/**
+ * Renew the awake budget for a wake that deliberately stays up: the board may
+ * stay awake for remaining_ms from now. Renew per stretch of work so the budget
+ * keeps guarding against hangs. No effect without a budget or once it expired.
+ *
+ * @param remaining_ms Awake time allowed from now
+ */
+void board_lifecycle_renew_awake_budget(uint32_t remaining_ms);
+
+/**
+ * Get the awake time left before the budget expires.
+ *
+ * @return Remaining milliseconds, UINT32_MAX when no budget is set
+ */
+uint32_t board_lifecycle_budget_remaining_ms(void);
+
+/**
+ * Get the time the calling wakeup callback has left: the smaller of its stage
+ * deadline and the awake budget. Callbacks bound their waits and retries by it
+ * and return once it reaches 0 (the stage has been abandoned).
+ *
+ * @return Remaining milliseconds; UINT32_MAX outside a wakeup callback without a
+ *         budget, or for a stage without deadline and no budget
+ */
+uint32_t board_lifecycle_stage_remaining_ms(void);
+
+/**
+ * Check whether the previous wake overran a stage deadline or the awake budget.
+ * Unlike board_lifecycle_get_wake_info() this may be called before
+ * board_lifecycle_wakeup(), e.g. to count the overrun before anything can hang again.
+ *
+ * @param stage Set to the stage that overran, BOARD_LIFECYCLE_NO_STAGE if
+ *              none or unknown (may be NULL)
+ * @return true if the previous wake overran
+ */
+bool board_lifecycle_last_wake_overran(uint8_t *stage);
+
+/**
+ * Get why the board is awake (valid after board_lifecycle_wakeup()).
+ *
+ * @return Wake cause, reset reason and RTC-persisted wake history
+ */
+board_lifecycle_wake_info board_lifecycle_get_wake_info(void);
+
+/**
+ * Get the name of the profile selected for this wake.
+ *
+ * @return Profile name, or "all" when no profiles are installed
+ */
+const char *board_lifecycle_get_profile_name(void);
+
+/**
+ * Check whether a stage is part of the profile selected for this wake.
+ *
+ * @param index Index of the stage in the lifecycle table
+ * @return true if the stage runs this wake
+ */
+bool board_lifecycle_stage_active(int8_t index);
+
+/**
+ * Execute all wakeup callbacks in dependency order.
  * Should be called early in setup() after serial initialization.
  *
- * Measures execution time for each callback and tracks failures.
- * Continues execution even if individual callbacks fail.
+ * Stages without a dependency between them run concurrently on separate
+ * FreeRTOS tasks; returns once every stage has completed. Falls back to
+ * sequential table order if the tasks cannot be created.
+ *
+ * Selects the wake profile first (see board_lifecycle_set_profiles()); only
+ * the profile's stages run. Stages that overrun their deadline are abandoned
+ * (graph mode only; in sequential mode the callbacks still see their deadline
+ * through board_lifecycle_stage_remaining_ms()). Waits up to
+ * BOARD_LIFECYCLE_CANCEL_GRACE_MS for abandoned stages to return. Measures
+ * execution time for each callback and tracks failures. Stages whose dependencies failed are skipped; independent
+ * stages still run.
  *
  * @return Status code indicating overall success or failure
  */
 board_lifecycle_status board_lifecycle_wakeup(void);
 
 /**
- * Execute all registered sleep callbacks in LIFO order.
+ * Get the outcome of a stage's wakeup callback from the last wakeup execution.
+ *
+ * @param index Index of the stage in the lifecycle table
+ * @return Result of the callback (INACTIVE if outside the active profile,
+ *         SKIPPED for invalid indices)
+ */
+board_lifecycle_result board_lifecycle_get_wakeup_result(int8_t index);
+
+/**
+ * Get how long a stage's wakeup callback ran in the last wakeup execution.
+ *
+ * @param index Index of the stage in the lifecycle table
+ * @return Callback run time in milliseconds (0 if not run or invalid index)
+ */
+uint32_t board_lifecycle_get_wakeup_time_ms(int8_t index);
+
+/**
+ * Get the sleep duration requested from board_lifecycle_enter_sleep() (or until
+ * the target of board_lifecycle_enter_sleep_until(), as of the call).
+ * Lets sleep callbacks account for the coming sleep interval.
+ *
+ * @return Seconds until the next timer wakeup (0 before sleep was requested)
+ */
+uint64_t board_lifecycle_get_sleep_seconds(void);
+
+/**
+ * Execute all sleep callbacks in reverse table order.
  * Should be called in prep_for_sleep() before entering deep sleep.
  *
- * Measures execution time for each callback and tracks failures.
- * Continues execution even if individual callbacks fail.
+ * Every sleep callback of the active profile runs, including those of stages
+ * whose wakeup failed or was skipped, so sleep callbacks must tolerate an
+ * uninitialized subsystem. The one exception is an abandoned stage whose
+ * wakeup callback still has not returned: its sleep callback would race it.
  *
- * @return Status code indicating overall success or failure
+ * @return BOARD_LIFECYCLE_SUCCESS (sleep callbacks cannot fail)
  */
 board_lifecycle_status board_lifecycle_prep_sleep(void);
 
 /**
  * Configure ESP32 timer wakeup and enter deep sleep.
+ * Disarms the awake budget and runs the sleep callbacks first.
  * This function does not return.
  *
  * @param seconds Number of seconds to sleep before waking up
  */
 void board_lifecycle_enter_sleep(uint64_t seconds);
 
+/**
+ * Run the sleep callbacks, then deep sleep until the RTC timer
+ * (esp_rtc_get_time_us()) reaches wake_rtc_us. The timer interval is computed
+ * after the callbacks, right before deep sleep, so the time they take does not
+ * move the wake. This function does not return.
+ *
+ * @param wake_rtc_us RTC time to wake at (at least BOARD_LIFECYCLE_MIN_SLEEP_US from the end of the callbacks)
+ */
+void board_lifecycle_enter_sleep_until(uint64_t wake_rtc_us);
+
+/**
+ * Wakeup callback latency of one stage across wakes.
+ * Percentiles are bucket upper bounds (coarse, log-spaced buckets).
+ */
+typedef struct
+{
+    uint32_t samples; // Wakes in which the stage's callback ran
+    uint32_t p50_ms;  // Median latency (bucket upper bound)
+    uint32_t p95_ms;  // 95th percentile latency (bucket upper bound)
+    uint32_t max_ms;  // Slowest run observed
+} board_lifecycle_latency;
+
+/**
+ * Get a stage's latency summary, accumulated in RTC memory across wakes since
+ * power-on or the last board_lifecycle_reset_latency(). Stages without a
+ * wakeup callback, or that were skipped / inactive, record nothing.
+ *
+ * @param index Index of the stage in the lifecycle table
+ * @param latency Output summary
+ * @return false for invalid indices
+ */
+bool board_lifecycle_get_stage_latency(int8_t index, board_lifecycle_latency *latency);
+
+/**
+ * Clear the latency histograms of all stages (e.g. after publishing them).
+ */
+void board_lifecycle_reset_latency(void);
+
 /**
  * Get current lifecycle metrics for debugging.
  * Returns metrics from the last wakeup/sleep execution.
@@ -111,7 +550,7 @@ board_lifecycle_metrics board_lifecycle_get_metrics(void);
 
 /**
  * Print lifecycle metrics to Serial for debugging.
- * Shows registration counts, failure counts, and execution times.
+ * Shows stage counts, failure counts, and execution times.
  */
 void board_lifecycle_print_metrics(void);
 
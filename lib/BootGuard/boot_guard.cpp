@@ -0,0 +1,179 @@
+#include "boot_guard.h"
+#include <Arduino.h>
+#include <rtc_store.h>
+
+typedef struct
+{
+    uint8_t phase; // boot_guard_phase
+    uint8_t crash_streak;
+    uint8_t last_reason; // esp_reset_reason_t
+    bool last_overran;
+    uint8_t overrun_stage;
+    uint32_t total_crashes;
+    uint32_t unreported_crashes;
+} guard_rtc_state;
+
+#define GUARD_RTC_STATE_VERSION 2
+
+static guard_rtc_state *state = NULL;
+
+static guard_rtc_state *rtc_state(void)
+{
+    if (state == NULL)
+    {
+        bool fresh = false;
+        state = rtc_store_claim<guard_rtc_state, RTC_SLOT_BOOT_GUARD>(GUARD_RTC_STATE_VERSION, &fresh);
+        if (fresh)
+        {
+            state->overrun_stage = BOOT_GUARD_NO_STAGE;
+        }
+    }
+    return state;
+}
+
+// Resets that mean the previous wake did not finish on its own
+static bool is_abnormal_reset(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_CPU_LOCKUP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+boot_guard_phase boot_guard_begin(bool last_wake_overran, uint8_t overrun_stage)
+{
+    guard_rtc_state *rtc = rtc_state();
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    // A wake that only reached deep sleep because a stage was abandoned (a hung
+    // fuel gauge, a stuck bus) would otherwise loop forever without a reset
+    bool overran = last_wake_overran && reason == ESP_RST_DEEPSLEEP;
+
+    if (is_abnormal_reset(reason) || overran)
+    {
+        if (rtc->crash_streak < UINT8_MAX)
+        {
+            rtc->crash_streak++;
+        }
+        rtc->last_reason = (uint8_t)reason;
+        rtc->last_overran = overran;
+        rtc->overrun_stage = overran ? overrun_stage : BOOT_GUARD_NO_STAGE;
+        rtc->total_crashes++;
+        rtc->unreported_crashes++;
+        rtc->phase = BOOT_GUARD_BACKOFF;
+    }
+    else if (reason == ESP_RST_DEEPSLEEP)
+    {
+        // The previous wake reached deep sleep: move one step back towards normal
+        switch (rtc->phase)
+        {
+        case BOOT_GUARD_BACKOFF:
+            rtc->phase = BOOT_GUARD_DEGRADED;
+            break;
+        case BOOT_GUARD_DEGRADED:
+            rtc->phase = BOOT_GUARD_RETRY;
+            break;
+        default:
+            rtc->phase = BOOT_GUARD_NORMAL;
+            rtc->crash_streak = 0;
+            break;
+        }
+    }
+
+    // Must survive a crash in this very wake
+    rtc_store_commit_slot(RTC_SLOT_BOOT_GUARD);
+
+    if (rtc->crash_streak > 0)
+    {
+        Serial.print(F("BootGuard: "));
+        Serial.print(rtc->crash_streak);
+        Serial.print(F(" consecutive crash(es), last "));
+        Serial.print(rtc->last_overran ? "overrun" : boot_guard_reason_name((esp_reset_reason_t)rtc->last_reason));
+        Serial.print(F(", phase "));
+        Serial.println(rtc->phase);
+    }
+
+    return (boot_guard_phase)rtc->phase;
+}
+
+boot_guard_phase boot_guard_get_phase(void)
+{
+    return (boot_guard_phase)rtc_state()->phase;
+}
+
+uint8_t boot_guard_level(void)
+{
+    const guard_rtc_state *rtc = rtc_state();
+    return (rtc->phase == BOOT_GUARD_DEGRADED) ? rtc->crash_streak : 0;
+}
+
+uint32_t boot_guard_backoff_s(void)
+{
+    const guard_rtc_state *rtc = rtc_state();
+    if (rtc->crash_streak == 0)
+    {
+        return 0;
+    }
+
+    uint32_t backoff_s = BOOT_GUARD_BASE_BACKOFF_S;
+    for (uint8_t i = 1; i < rtc->crash_streak && backoff_s < BOOT_GUARD_MAX_BACKOFF_S; i++)
+    {
+        backoff_s *= 2;
+    }
+    return (backoff_s < BOOT_GUARD_MAX_BACKOFF_S) ? backoff_s : BOOT_GUARD_MAX_BACKOFF_S;
+}
+
+boot_guard_status boot_guard_get_status(void)
+{
+    const guard_rtc_state *rtc = rtc_state();
+    boot_guard_status status = {
+        .phase = (boot_guard_phase)rtc->phase,
+        .crash_streak = rtc->crash_streak,
+        .last_reason = (esp_reset_reason_t)rtc->last_reason,
+        .last_overran = rtc->last_overran,
+        .overrun_stage = rtc->overrun_stage,
+        .backoff_s = boot_guard_backoff_s(),
+        .total_crashes = rtc->total_crashes,
+        .unreported_crashes = rtc->unreported_crashes};
+    return status;
+}
+
+void boot_guard_mark_reported(void)
+{
+    rtc_state()->unreported_crashes = 0;
+    rtc_store_commit_slot(RTC_SLOT_BOOT_GUARD);
+}
+
+const char *boot_guard_reason_name(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_PANIC:
+        return "panic";
+    case ESP_RST_INT_WDT:
+        return "int_wdt";
+    case ESP_RST_TASK_WDT:
+        return "task_wdt";
+    case ESP_RST_WDT:
+        return "wdt";
+    case ESP_RST_CPU_LOCKUP:
+        return "cpu_lockup";
+    case ESP_RST_BROWNOUT:
+        return "brownout";
+    case ESP_RST_SW:
+        return "sw";
+    case ESP_RST_DEEPSLEEP:
+        return "deepsleep";
+    case ESP_RST_POWERON:
+        return "poweron";
+    default:
+        return "unknown";
+    }
+}
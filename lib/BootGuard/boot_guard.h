@@ -0,0 +1,115 @@
+#ifndef BOOT_GUARD_H
+#define BOOT_GUARD_H
+
+#include <stdint.h>
+#include <esp_system.h>
+
+/**
+ * Boot-Loop Guard
+ *
+ * Counts consecutive abnormal wakes in RTC memory so a fault that crashes or
+ * hangs every wake (an I2C hang, a driver fault) cannot reboot the node
+ * straight back into the same wake until the battery is flat. Abnormal wakes
+ * are abnormal resets (panic, watchdogs) and wakes that reached deep sleep only
+ * because a stage overran its deadline or the awake budget (the caller passes
+ * that in, e.g. from the lifecycle engine).
+ *
+ * After an abnormal reset the guard asks for a backoff sleep first, doubling
+ * with every consecutive crash. The wake after the backoff runs degraded, one
+ * step further per crash (the application maps levels to wake profiles). Once
+ * a degraded wake has reached deep sleep the next wake retries the regular
+ * path; a regular wake reaching deep sleep clears the streak.
+ *
+ *   crash -> backoff sleep -> degraded wake -> sleep -> regular wake -> sleep (healthy)
+ *                                                         '-> crash: streak + 1
+ *
+ * The guard's state is committed to the RTC store as soon as it changes, so
+ * it survives the next crash. Brownouts discard the RTC store and are not
+ * counted.
+ */
+
+// Backoff sleep after the first abnormal reset; doubles per consecutive crash (seconds)
+#ifndef BOOT_GUARD_BASE_BACKOFF_S
+#define BOOT_GUARD_BASE_BACKOFF_S 300
+#endif
+
+// Upper bound of the backoff sleep (seconds)
+#ifndef BOOT_GUARD_MAX_BACKOFF_S
+#define BOOT_GUARD_MAX_BACKOFF_S (12 * 3600)
+#endif
+
+// No overrunning stage (boot_guard_begin(), boot_guard_status)
+#define BOOT_GUARD_NO_STAGE 0xFF
+
+/**
+ * What this wake should do.
+ */
+typedef enum
+{
+    BOOT_GUARD_NORMAL = 0, // No recent crash: regular wake
+    BOOT_GUARD_BACKOFF,    // Just crashed: sleep boot_guard_backoff_s() before anything else
+    BOOT_GUARD_DEGRADED,   // Backoff done: run degraded at boot_guard_level()
+    BOOT_GUARD_RETRY       // Degraded wake completed: retry the regular wake
+} boot_guard_phase;
+
+/**
+ * Crash history, for logs and reporting.
+ */
+typedef struct
+{
+    boot_guard_phase phase;
+    uint8_t crash_streak;          // Consecutive abnormal wakes (0 once a regular wake completed)
+    esp_reset_reason_t last_reason; // Reset reason of the most recent abnormal wake
+    bool last_overran;             // Most recent abnormal wake was an overrun, not a crash
+    uint8_t overrun_stage;         // Stage that overran, BOOT_GUARD_NO_STAGE if unknown or a crash
+    uint32_t backoff_s;            // Backoff sleep for the current streak (0 if none)
+    uint32_t total_crashes;        // Abnormal wakes since power-on
+    uint32_t unreported_crashes;   // Abnormal wakes not yet acknowledged by boot_guard_mark_reported()
+} boot_guard_status;
+
+/**
+ * Read the reset reason and advance the guard. Call once, early in setup(),
+ * before anything that may hang or crash.
+ *
+ * @param last_wake_overran The previous wake overran a stage deadline or the
+ *                          awake budget (counted like a crash)
+ * @param overrun_stage Stage that overran, BOOT_GUARD_NO_STAGE if unknown (reporting only)
+ * @return Phase of this wake
+ */
+boot_guard_phase boot_guard_begin(bool last_wake_overran, uint8_t overrun_stage);
+
+/**
+ * Get the phase decided by boot_guard_begin().
+ */
+boot_guard_phase boot_guard_get_phase(void);
+
+/**
+ * Get how far a degraded wake should step down.
+ *
+ * @return Consecutive crashes in the degraded phase (1 = first step), 0 otherwise
+ */
+uint8_t boot_guard_level(void);
+
+/**
+ * Get the backoff sleep for the current crash streak.
+ *
+ * @return Seconds, 0 without a crash streak
+ */
+uint32_t boot_guard_backoff_s(void);
+
+/**
+ * Get the crash history.
+ */
+boot_guard_status boot_guard_get_status(void);
+
+/**
+ * Acknowledge the crashes counted so far (e.g. once published).
+ */
+void boot_guard_mark_reported(void);
+
+/**
+ * Short name of a reset reason for logs and reports ("panic", "task_wdt", ...).
+ */
+const char *boot_guard_reason_name(esp_reset_reason_t reason);
+
+#endif // BOOT_GUARD_H
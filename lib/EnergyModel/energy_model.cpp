@@ -0,0 +1,210 @@
+#include "energy_model.h"
+#include <esp_timer.h>
+#include <rtc_store.h>
+
+static const energy_model_currents default_currents = {
+    {ENERGY_MODEL_CPU_ACTIVE_MA, ENERGY_MODEL_RADIO_RX_MA, ENERGY_MODEL_RADIO_TX_MA,
+     ENERGY_MODEL_PERIPHERAL_RAIL_MA, ENERGY_MODEL_LED_MA},
+    ENERGY_MODEL_DEEP_SLEEP_UA};
+
+static energy_model_currents currents = default_currents;
+
+// Load on-time of the current wake
+static uint32_t state_ms[ENERGY_STATE_COUNT];
+static uint32_t state_on_since_ms[ENERGY_STATE_COUNT];
+static bool state_on[ENERGY_STATE_COUNT];
+static float stage_uah[ENERGY_MODEL_MAX_STAGES];
+static uint8_t stage_count = 0;
+static bool wake_finished = false;
+
+// CPU clock history of the current wake (see energy_model_set_cpu_mhz())
+static uint32_t cpu_reference_mhz = 0;
+static uint32_t cpu_mhz = 0;
+static uint32_t cpu_mhz_since_ms = 0;
+static float cpu_clock_adjust_ms = 0; // Extra (or, when negative, saved) CPU time at reference current
+
+// Last completed wake and totals, surviving deep sleep (RTC store slot)
+typedef struct
+{
+    energy_model_report report;
+    double total_uah;
+} energy_rtc_state;
+
+#define ENERGY_RTC_STATE_VERSION 1
+
+static energy_rtc_state *rtc_state(void)
+{
+    static energy_rtc_state *rtc = NULL;
+    if (rtc == NULL)
+    {
+        rtc = rtc_store_claim<energy_rtc_state, RTC_SLOT_ENERGY>(ENERGY_RTC_STATE_VERSION);
+    }
+    return rtc;
+}
+
+// Charge drawn by a current over a time span (mA * ms -> uAh)
+static float charge_uah(float ma, uint32_t ms)
+{
+    return ma * (float)ms / 3600.0f;
+}
+
+// CPU current at a clock relative to the reference clock
+static float cpu_clock_scale(uint32_t mhz)
+{
+    if (cpu_reference_mhz == 0 || mhz == 0)
+    {
+        return 1.0f;
+    }
+    return ENERGY_MODEL_CPU_STATIC_FRACTION +
+           (1.0f - ENERGY_MODEL_CPU_STATIC_FRACTION) * (float)mhz / (float)cpu_reference_mhz;
+}
+
+void energy_model_set_cpu_mhz(uint32_t mhz)
+{
+    uint32_t now = millis();
+    if (cpu_reference_mhz == 0)
+    {
+        cpu_reference_mhz = mhz;
+    }
+    else
+    {
+        cpu_clock_adjust_ms += (cpu_clock_scale(cpu_mhz) - 1.0f) * (float)(now - cpu_mhz_since_ms);
+    }
+    cpu_mhz = mhz;
+    cpu_mhz_since_ms = now;
+}
+
+void energy_model_set_currents(const energy_model_currents *new_currents)
+{
+    currents = (new_currents != NULL) ? *new_currents : default_currents;
+}
+
+void energy_model_state_on(energy_model_state state)
+{
+    if (state >= ENERGY_STATE_COUNT || state_on[state])
+    {
+        return;
+    }
+    state_on[state] = true;
+    state_on_since_ms[state] = millis();
+}
+
+void energy_model_state_off(energy_model_state state)
+{
+    if (state >= ENERGY_STATE_COUNT || !state_on[state])
+    {
+        return;
+    }
+    state_on[state] = false;
+    state_ms[state] += millis() - state_on_since_ms[state];
+}
+
+void energy_model_add_state_time(energy_model_state state, uint32_t ms)
+{
+    if (state < ENERGY_STATE_COUNT)
+    {
+        state_ms[state] += ms;
+    }
+}
+
+void energy_model_record_stage(uint8_t index, uint32_t ms, uint8_t state_mask, uint32_t stage_cpu_mhz)
+{
+    if (index >= ENERGY_MODEL_MAX_STAGES)
+    {
+        return;
+    }
+
+    float ma = currents.state_ma[ENERGY_STATE_CPU_ACTIVE] * cpu_clock_scale(stage_cpu_mhz);
+    for (uint8_t state = ENERGY_STATE_RADIO_RX; state < ENERGY_STATE_COUNT; state++)
+    {
+        if (state_mask & ENERGY_STATE_MASK(state))
+        {
+            ma += currents.state_ma[state];
+        }
+    }
+
+    stage_uah[index] = charge_uah(ma, ms);
+    if (index >= stage_count)
+    {
+        stage_count = index + 1;
+    }
+}
+
+void energy_model_finish_wake(uint64_t sleep_seconds)
+{
+    if (wake_finished)
+    {
+        return;
+    }
+    wake_finished = true;
+
+    for (uint8_t state = ENERGY_STATE_RADIO_RX; state < ENERGY_STATE_COUNT; state++)
+    {
+        energy_model_state_off((energy_model_state)state);
+    }
+
+    // The CPU runs from app start until now (esp_timer starts with the app); ROM and
+    // bootloader time is added by the caller through energy_model_add_state_time()
+    state_ms[ENERGY_STATE_CPU_ACTIVE] += (uint32_t)(esp_timer_get_time() / 1000);
+    energy_model_set_cpu_mhz(cpu_mhz); // Close the current clock interval
+
+    energy_model_report &rtc_report = rtc_state()->report;
+    float cpu_ms = (float)state_ms[ENERGY_STATE_CPU_ACTIVE] + cpu_clock_adjust_ms;
+    float wake_uah = currents.state_ma[ENERGY_STATE_CPU_ACTIVE] * (cpu_ms > 0 ? cpu_ms : 0) / 3600.0f;
+    rtc_report.last_state_ms[ENERGY_STATE_CPU_ACTIVE] = state_ms[ENERGY_STATE_CPU_ACTIVE];
+    for (uint8_t state = ENERGY_STATE_RADIO_RX; state < ENERGY_STATE_COUNT; state++)
+    {
+        wake_uah += charge_uah(currents.state_ma[state], state_ms[state]);
+        rtc_report.last_state_ms[state] = state_ms[state];
+    }
+
+    for (uint8_t i = 0; i < ENERGY_MODEL_MAX_STAGES; i++)
+    {
+        rtc_report.last_stage_uah[i] = (i < stage_count) ? stage_uah[i] : 0;
+    }
+    rtc_report.stage_count = stage_count;
+
+    rtc_report.last_wake_uah = wake_uah;
+    rtc_report.last_sleep_uah = currents.deep_sleep_ua * (float)sleep_seconds / 3600.0f;
+
+    // Account the coming sleep now; it is not interrupted short of a reset,
+    // which clears RTC memory anyway
+    rtc_state()->total_uah += rtc_report.last_wake_uah + rtc_report.last_sleep_uah;
+    rtc_report.total_mah = (float)(rtc_state()->total_uah / 1000.0);
+    rtc_report.wake_count++;
+}
+
+energy_model_report energy_model_get_report(void)
+{
+    return rtc_state()->report;
+}
+
+void energy_model_print_report(void)
+{
+    static const char *const state_names[ENERGY_STATE_COUNT] = {"cpu", "radio_rx", "radio_tx", "rail", "led"};
+    const energy_model_report &rtc_report = rtc_state()->report;
+
+    Serial.println(F("EnergyModel: ===== Energy Report (last wake) ====="));
+    Serial.print(F("  Wake charge:        "));
+    Serial.print(rtc_report.last_wake_uah, 1);
+    Serial.println(F(" uAh"));
+    Serial.print(F("  Sleep charge:       "));
+    Serial.print(rtc_report.last_sleep_uah, 1);
+    Serial.println(F(" uAh"));
+
+    for (uint8_t state = 0; state < ENERGY_STATE_COUNT; state++)
+    {
+        Serial.print(F("  "));
+        Serial.print(state_names[state]);
+        Serial.print(F(": "));
+        Serial.print(rtc_report.last_state_ms[state]);
+        Serial.println(F("ms"));
+    }
+
+    Serial.print(F("  Total since power-on: "));
+    Serial.print(rtc_report.total_mah, 3);
+    Serial.print(F(" mAh over "));
+    Serial.print(rtc_report.wake_count);
+    Serial.println(F(" wakes"));
+    Serial.println(F("EnergyModel: ================================="));
+}
@@ -0,0 +1,152 @@
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <Arduino.h>
+
+/**
+ * Energy Model
+ *
+ * Estimates charge drawn per wake and per sleep interval from the time spent
+ * in each power state and a configurable current per state. Loads are tracked
+ * as on/off intervals (they overlap freely: CPU + radio + peripheral rail);
+ * per-stage figures attribute a stage's callback time to the loads it drives.
+ *
+ * Totals survive deep sleep in RTC memory, so trends across firmware versions
+ * and sites are visible without a power analyzer. Figures are estimates: they
+ * are only as good as the configured currents.
+ */
+
+// Typical current per state (mA), override via build flags per board/site.
+// Loads add up: radio and rail currents are on top of the CPU current, and
+// TX is the extra current on top of RX while transmitting.
+#ifndef ENERGY_MODEL_CPU_ACTIVE_MA
+#define ENERGY_MODEL_CPU_ACTIVE_MA 25.0f
+#endif
+
+// Share of the CPU current that does not scale with the clock (leakage, flash,
+// regulators); the rest scales linearly from the boot clock
+#ifndef ENERGY_MODEL_CPU_STATIC_FRACTION
+#define ENERGY_MODEL_CPU_STATIC_FRACTION 0.3f
+#endif
+
+#ifndef ENERGY_MODEL_RADIO_RX_MA
+#define ENERGY_MODEL_RADIO_RX_MA 60.0f
+#endif
+
+#ifndef ENERGY_MODEL_RADIO_TX_MA
+#define ENERGY_MODEL_RADIO_TX_MA 100.0f
+#endif
+
+#ifndef ENERGY_MODEL_PERIPHERAL_RAIL_MA
+#define ENERGY_MODEL_PERIPHERAL_RAIL_MA 5.0f
+#endif
+
+#ifndef ENERGY_MODEL_LED_MA
+#define ENERGY_MODEL_LED_MA 10.0f
+#endif
+
+// Whole-board deep sleep current (uA)
+#ifndef ENERGY_MODEL_DEEP_SLEEP_UA
+#define ENERGY_MODEL_DEEP_SLEEP_UA 20.0f
+#endif
+
+// Maximum number of stages with per-stage accounting
+#define ENERGY_MODEL_MAX_STAGES 16
+
+/**
+ * Power states with their own current draw.
+ */
+typedef enum
+{
+    ENERGY_STATE_CPU_ACTIVE = 0, // Awake, always on while the board runs
+    ENERGY_STATE_RADIO_RX,       // WiFi associated / listening
+    ENERGY_STATE_RADIO_TX,       // Transmitting (publishing), overlaps RX
+    ENERGY_STATE_PERIPHERAL_RAIL,
+    ENERGY_STATE_LED,
+    ENERGY_STATE_COUNT
+} energy_model_state;
+
+// Bitmask of energy_model_state values (for per-stage loads)
+#define ENERGY_STATE_MASK(state) ((uint8_t)(1U << (state)))
+
+/**
+ * Current draw per state.
+ */
+typedef struct
+{
+    float state_ma[ENERGY_STATE_COUNT]; // Active current per state (mA)
+    float deep_sleep_ua;                // Deep sleep current (uA)
+} energy_model_currents;
+
+/**
+ * Energy report. "last_*" values describe the most recently completed wake,
+ * which is the previous one until energy_model_finish_wake() ran.
+ */
+typedef struct
+{
+    float last_wake_uah;                            // Charge of the last wake (uAh)
+    float last_sleep_uah;                           // Charge of the sleep interval that followed it (uAh)
+    uint32_t last_state_ms[ENERGY_STATE_COUNT];     // Time spent in each state during the last wake
+    float last_stage_uah[ENERGY_MODEL_MAX_STAGES];  // Charge attributed to each stage during the last wake
+    uint8_t stage_count;                            // Valid entries in last_stage_uah
+    float total_mah;                                // Accumulated since power-on (RTC)
+    uint32_t wake_count;                            // Wakes accounted since power-on (RTC)
+} energy_model_report;
+
+/**
+ * Override the default (build flag) currents.
+ *
+ * @param currents Current draw per state, NULL restores the defaults
+ */
+void energy_model_set_currents(const energy_model_currents *currents);
+
+/**
+ * Mark a load as switched on / off. Repeated calls are harmless.
+ * ENERGY_STATE_CPU_ACTIVE is implicit (app start to energy_model_finish_wake()).
+ */
+void energy_model_state_on(energy_model_state state);
+void energy_model_state_off(energy_model_state state);
+
+/**
+ * Add on-time measured elsewhere (e.g. the status LED tracks its own, or the
+ * ROM/bootloader time before app start for ENERGY_STATE_CPU_ACTIVE).
+ */
+void energy_model_add_state_time(energy_model_state state, uint32_t ms);
+
+/**
+ * Report a CPU clock change. The first clock reported is the reference
+ * ENERGY_MODEL_CPU_ACTIVE_MA applies to; CPU time at other clocks is scaled.
+ *
+ * @param mhz Clock now in effect
+ */
+void energy_model_set_cpu_mhz(uint32_t mhz);
+
+/**
+ * Attribute a stage's callback time to the CPU and the loads it drives.
+ *
+ * @param index Stage index (< ENERGY_MODEL_MAX_STAGES)
+ * @param ms Stage run time
+ * @param state_mask ENERGY_STATE_MASK() bits of the loads the stage holds on
+ * @param cpu_mhz Clock the stage ran at, 0 for the reference clock
+ */
+void energy_model_record_stage(uint8_t index, uint32_t ms, uint8_t state_mask, uint32_t cpu_mhz);
+
+/**
+ * Close the wake: stop all loads, compute the wake charge and account the
+ * coming sleep interval. Call once, right before deep sleep.
+ *
+ * @param sleep_seconds Planned deep sleep duration
+ */
+void energy_model_finish_wake(uint64_t sleep_seconds);
+
+/**
+ * Get the energy report (last completed wake plus running totals).
+ */
+energy_model_report energy_model_get_report(void);
+
+/**
+ * Print the energy report to Serial.
+ */
+void energy_model_print_report(void);
+
+#endif // ENERGY_MODEL_H
@@ -1,10 +1,76 @@
 #ifndef BOARD_GPIO_CONFIG_H
 #define BOARD_GPIO_CONFIG_H
 
+#include <stdint.h>
 #include "../../include/board_config.h"
+#include "../../include/soil_sensor_config.h"
+#include "gpio_audit.h"
 
 // Board-specific GPIO pin definitions for power management during deep sleep
-// These configurations isolate GPIOs to prevent current leakage
+// These configurations isolate GPIOs to prevent current leakage.
+//
+// Each board is described by a compile-time descriptor; the masks applied at
+// sleep entry are computed (and cross-checked) by the compiler.
+
+// Bitmask of GPIO numbers; negative (unused) pins are ignored
+constexpr uint64_t gpio_mask()
+{
+    return 0;
+}
+
+template <typename... Pins>
+constexpr uint64_t gpio_mask(int pin, Pins... pins)
+{
+    return ((pin >= 0) ? (1ULL << pin) : 0ULL) | gpio_mask(pins...);
+}
+
+/**
+ * GPIO roles of a board.
+ *
+ * @tparam GpioCount Number of GPIOs on the chip (GPIO0 .. GpioCount-1)
+ */
+template <uint8_t GpioCount>
+struct board_gpio_descriptor
+{
+    static constexpr uint8_t gpio_count = GpioCount;
+    static constexpr uint64_t chip_mask = (GpioCount >= 64) ? ~0ULL : ((1ULL << GpioCount) - 1);
+
+    uint64_t reserved_mask;    // Strapping / flash / PSRAM pins: never touched
+    uint64_t application_mask; // Driven by application modules through sleep (power rail, LED, sensor)
+    uint64_t hold_mask;        // Latched through deep sleep (part of application_mask)
+    uint64_t hold_high_mask;   // Held pins whose OFF level is HIGH (the rest of hold_mask is held LOW)
+    uint64_t wake_only_mask;   // Used while awake only, isolated at sleep (I2C, board LED)
+    uint64_t console_mask;     // UART / USB, isolated last (ends Serial output)
+
+    // Pins power management must not isolate
+    constexpr uint64_t active_mask() const
+    {
+        return reserved_mask | application_mask;
+    }
+
+    // Pins pulled down at sleep entry (console pins are handled separately, last)
+    constexpr uint64_t isolate_mask() const
+    {
+        return chip_mask & ~active_mask() & ~console_mask;
+    }
+
+    // Application pins power management pulls down at sleep entry, whether or
+    // not the module that drives them ran this wake
+    constexpr uint64_t application_pulldown_mask() const
+    {
+        return application_mask & ~hold_mask;
+    }
+
+    // State a pin should be in once sleep preparation is done (held pins at
+    // their OFF level, every other non-reserved pin pulled down)
+    constexpr gpio_sleep_expect expected_sleep_state(uint8_t pin) const
+    {
+        return (pin >= GpioCount || (reserved_mask & (1ULL << pin))) ? GPIO_SLEEP_UNCHECKED
+               : (hold_high_mask & (1ULL << pin))                    ? GPIO_SLEEP_HELD_HIGH
+               : (hold_mask & (1ULL << pin))                         ? GPIO_SLEEP_HELD_LOW
+                                                                     : GPIO_SLEEP_PULLDOWN;
+    }
+};
 
 #if defined(BOARD_TYPE_ESP32C6)
     // ESP32-C6 SparkFun Thing Plus GPIO Configuration
@@ -21,31 +87,18 @@
     #define I2C_SDA_PIN 6
     #define I2C_SCL_PIN 7
 
-    // GPIOs that should NOT be isolated (actively used + reserved system pins)
-    static const uint8_t ACTIVE_PINS_C6[] = {
-        // User pins (actively used by application)
-        PERIPHERAL_POWER_PIN,  // GPIO15 - controls peripheral power (inverted logic)
-        STATUS_LED_PIN,        // GPIO23 - RGB status LED (handled separately)
-        BOARD_LED_PIN,         // GPIO8 - board LED (also strapping pin)
-        4,                     // GPIO4 - soil sensor analog input (handled by SoilSensor lib)
-        I2C_SDA_PIN,           // GPIO6 - I2C data (handled by BatteryMonitor lib)
-        I2C_SCL_PIN,           // GPIO7 - I2C clock (handled by BatteryMonitor lib)
-
+    static constexpr board_gpio_descriptor<31> BOARD_GPIO = {
         // Reserved system pins (MUST NOT isolate - prevents potential issues)
-        2,   // Strapping: Boot mode selection
-        9,   // Strapping: Boot mode selection (also used for I2C SCL in some configs)
-        24,  // Flash: SPICS0 (chip select)
-        25,  // Flash: SPIQ (data)
-        26,  // Flash: SPID (data)
-        27,  // Flash: SPIWP (write protect)
-        28,  // Flash: SPIHD (hold signal)
-        29,  // Flash: SPICLK (clock)
-        30   // Flash: SPICS1 (chip select)
+        gpio_mask(2, 9,                          // Strapping: boot mode selection
+                  24, 25, 26, 27, 28, 29, 30),   // Flash: SPICS0, SPIQ, SPID, SPIWP, SPIHD, SPICLK, SPICS1
+        // Application pins (GPIO15 peripheral power, GPIO23 RGB LED, GPIO4 soil sensor)
+        gpio_mask(PERIPHERAL_POWER_PIN, STATUS_LED_PIN, SOIL_SENSOR_AOUT_PIN),
+        gpio_mask(PERIPHERAL_POWER_PIN),
+        gpio_mask(PERIPHERAL_POWER_INVERTED ? PERIPHERAL_POWER_PIN : -1),
+        gpio_mask(I2C_SDA_PIN, I2C_SCL_PIN, BOARD_LED_PIN),
+        gpio_mask(UART_TX_PIN, UART_RX_PIN, USB_DM_PIN, USB_DP_PIN),
     };
 
-    #define ACTIVE_PINS_COUNT (sizeof(ACTIVE_PINS_C6) / sizeof(ACTIVE_PINS_C6[0]))
-    #define ACTIVE_PINS ACTIVE_PINS_C6
-
 #elif defined(BOARD_TYPE_ESP32S3)
     // ESP32-S3 SparkFun Thing Plus GPIO Configuration
 
@@ -57,39 +110,23 @@
     #define USB_DM_PIN 19
     #define USB_DP_PIN 20
 
-    // I2C pins (default Wire pins for ESP32-S3)
+    // I2C pins (default Wire pins for ESP32-S3; GPIO8 is also the board LED)
     #define I2C_SDA_PIN 8
     #define I2C_SCL_PIN 9
 
-    // GPIOs that should NOT be isolated (actively used + reserved system pins)
-    static const uint8_t ACTIVE_PINS_S3[] = {
-        // User pins (actively used by application)
-        PERIPHERAL_POWER_PIN,  // GPIO45 - controls peripheral power (also strapping pin)
-        STATUS_LED_PIN,        // GPIO46 - RGB status LED (also strapping pin)
-        4,                     // GPIO4 - soil sensor analog input (handled by SoilSensor lib)
-        I2C_SDA_PIN,           // GPIO8 - I2C data (also BOARD_LED, handled by BatteryMonitor lib)
-        I2C_SCL_PIN,           // GPIO9 - I2C clock (handled by BatteryMonitor lib)
-
+    static constexpr board_gpio_descriptor<49> BOARD_GPIO = {
         // Reserved system pins (MUST NOT isolate - causes watchdog crashes)
-        0,   // Strapping: Boot mode selection
-        3,   // Strapping: JTAG enable
-        26,  // Flash: SPICS1
-        27,  // Flash: SPIHD (hold signal)
-        28,  // Flash: SPIWP (write protect)
-        29,  // Flash: SPICS0 (chip select)
-        30,  // Flash: SPICLK (clock)
-        31,  // Flash: SPIQ (data I/O)
-        32,  // Flash: SPID (data I/O)
-        33,  // Octal PSRAM: SPIIO4 (if used)
-        34,  // Octal PSRAM: SPIIO5 (if used)
-        35,  // Octal PSRAM: SPIIO6 (if used)
-        36,  // Octal PSRAM: SPIIO7 (if used)
-        37   // Octal PSRAM: SPIDQS (if used)
+        gpio_mask(0, 3,                          // Strapping: boot mode, JTAG enable
+                  26, 27, 28, 29, 30, 31, 32,    // Flash: SPICS1, SPIHD, SPIWP, SPICS0, SPICLK, SPIQ, SPID
+                  33, 34, 35, 36, 37),           // Octal PSRAM: SPIIO4-7, SPIDQS (if used)
+        // Application pins (GPIO45 peripheral power, GPIO46 RGB LED, GPIO4 soil sensor)
+        gpio_mask(PERIPHERAL_POWER_PIN, STATUS_LED_PIN, SOIL_SENSOR_AOUT_PIN),
+        gpio_mask(PERIPHERAL_POWER_PIN),
+        gpio_mask(PERIPHERAL_POWER_INVERTED ? PERIPHERAL_POWER_PIN : -1),
+        gpio_mask(I2C_SDA_PIN, I2C_SCL_PIN, BOARD_LED_PIN),
+        gpio_mask(UART_TX_PIN, UART_RX_PIN, USB_DM_PIN, USB_DP_PIN),
     };
 
-    #define ACTIVE_PINS_COUNT (sizeof(ACTIVE_PINS_S3) / sizeof(ACTIVE_PINS_S3[0]))
-    #define ACTIVE_PINS ACTIVE_PINS_S3
-
 #else
     #warning "Unknown board type for GPIO power management"
 
@@ -101,9 +138,32 @@
     #define I2C_SDA_PIN 21
     #define I2C_SCL_PIN 22
 
-    static const uint8_t ACTIVE_PINS_DEFAULT[] = {4, 8, 21, 22};
-    #define ACTIVE_PINS_COUNT (sizeof(ACTIVE_PINS_DEFAULT) / sizeof(ACTIVE_PINS_DEFAULT[0]))
-    #define ACTIVE_PINS ACTIVE_PINS_DEFAULT
+    // Sized for the largest supported chip; pins past GPIO39 are left alone
+    static constexpr board_gpio_descriptor<49> BOARD_GPIO = {
+        gpio_mask(40, 41, 42, 43, 44, 45, 46, 47, 48) & ~gpio_mask(PERIPHERAL_POWER_PIN),
+        gpio_mask(PERIPHERAL_POWER_PIN, SOIL_SENSOR_AOUT_PIN, 8),
+        gpio_mask(PERIPHERAL_POWER_PIN),
+        gpio_mask(PERIPHERAL_POWER_INVERTED ? PERIPHERAL_POWER_PIN : -1),
+        gpio_mask(I2C_SDA_PIN, I2C_SCL_PIN),
+        gpio_mask(UART_TX_PIN, UART_RX_PIN, USB_DM_PIN, USB_DP_PIN),
+    };
 #endif
 
+#define BOARD_GPIO_COUNT (BOARD_GPIO.gpio_count)
+
+// Board table mistakes that would leak current or break boot fail the build
+static_assert(((BOARD_GPIO.reserved_mask | BOARD_GPIO.application_mask | BOARD_GPIO.wake_only_mask |
+                BOARD_GPIO.console_mask) & ~BOARD_GPIO.chip_mask) == 0,
+              "Board GPIO descriptor names a pin the chip does not have");
+static_assert((BOARD_GPIO.active_mask() & (BOARD_GPIO.wake_only_mask | BOARD_GPIO.console_mask)) == 0,
+              "A GPIO is both active (reserved/application) and isolated at sleep");
+static_assert((BOARD_GPIO.wake_only_mask & BOARD_GPIO.console_mask) == 0,
+              "A GPIO is both a wake-only pin and a console pin");
+static_assert((BOARD_GPIO.hold_mask & ~BOARD_GPIO.application_mask) == 0,
+              "Held GPIOs must be application pins");
+static_assert((BOARD_GPIO.hold_high_mask & ~BOARD_GPIO.hold_mask) == 0,
+              "A GPIO held HIGH must be in the hold mask");
+static_assert((BOARD_GPIO.hold_mask & BOARD_GPIO.reserved_mask) == 0,
+              "A reserved (strapping/flash) GPIO must not be held through sleep");
+
 #endif // BOARD_GPIO_CONFIG_H
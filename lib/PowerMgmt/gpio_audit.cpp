@@ -0,0 +1,29 @@
+#include "gpio_audit.h"
+
+bool gpio_audit_pin_ok(gpio_sleep_expect expect, const gpio_pin_state *state)
+{
+    switch (expect)
+    {
+    case GPIO_SLEEP_PULLDOWN:
+        return !state->output_enabled && state->pull_down && !state->pull_up;
+
+    case GPIO_SLEEP_HELD_LOW:
+    case GPIO_SLEEP_HELD_HIGH:
+        // A rail latched at its ON level passes the hold check but drains the battery
+        return state->output_enabled && state->held && state->level == (expect == GPIO_SLEEP_HELD_HIGH);
+
+    case GPIO_SLEEP_UNCHECKED:
+    default:
+        return true;
+    }
+}
+
+uint8_t gpio_audit_pack(const gpio_pin_state *state)
+{
+    return (state->input_enabled ? 0x01 : 0) |
+           (state->output_enabled ? 0x02 : 0) |
+           (state->pull_up ? 0x04 : 0) |
+           (state->pull_down ? 0x08 : 0) |
+           (state->held ? 0x10 : 0) |
+           (state->level ? 0x20 : 0);
+}
@@ -0,0 +1,55 @@
+#ifndef GPIO_AUDIT_H
+#define GPIO_AUDIT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * GPIO Sleep Audit
+ *
+ * Compares the configuration each GPIO actually ended up in before deep sleep
+ * with the state the board descriptor expects, so a pin left floating (which
+ * can double sleep current) shows up in diagnostics instead of as short
+ * battery life.
+ *
+ * Plain C++ with no Arduino / ESP-IDF dependencies so it builds on the host.
+ */
+
+/**
+ * State a GPIO is expected to sleep in.
+ */
+typedef enum
+{
+    GPIO_SLEEP_UNCHECKED = 0, // Reserved (strapping / flash / PSRAM): left as the system set it
+    GPIO_SLEEP_PULLDOWN,      // Input, pull-down only, not driven
+    GPIO_SLEEP_HELD_LOW,      // Driven output latched LOW with GPIO hold
+    GPIO_SLEEP_HELD_HIGH      // Driven output latched HIGH with GPIO hold
+} gpio_sleep_expect;
+
+/**
+ * Observed configuration of one GPIO.
+ */
+typedef struct
+{
+    bool input_enabled;
+    bool output_enabled;
+    bool pull_up;
+    bool pull_down;
+    bool held;
+    bool level; // Pad level (the driven level for outputs)
+} gpio_pin_state;
+
+/**
+ * Check one pin against its expected sleep state.
+ *
+ * @return true if the pin is in the expected state (always for GPIO_SLEEP_UNCHECKED)
+ */
+bool gpio_audit_pin_ok(gpio_sleep_expect expect, const gpio_pin_state *state);
+
+/**
+ * Pack a pin state into one byte (bits: input, output, pull-up, pull-down, held, level).
+ * A run of packed states is what the audit digest is computed over.
+ */
+uint8_t gpio_audit_pack(const gpio_pin_state *state);
+
+#endif // GPIO_AUDIT_H
@@ -2,24 +2,163 @@
 #include "board_gpio_config.h"
 #include <driver/gpio.h>
 #include <esp_sleep.h>
+#include <esp_pm.h>
+#include <esp_rom_crc.h>
+#include <WiFi.h>
+#include <rtc_store.h>
 
 // Forward declaration for btStop (from esp32-hal-bt.c)
 extern "C" bool btStop();
 
-// Check if a GPIO pin should be actively managed (not isolated)
-static bool is_active_pin(uint8_t pin)
+// GPIO audit of the last sleep preparation (RTC store slot)
+typedef struct
 {
-    for (size_t i = 0; i < ACTIVE_PINS_COUNT; i++)
+    power_mgmt_gpio_audit audit;
+} power_mgmt_rtc_state;
+
+#define POWER_MGMT_RTC_STATE_VERSION 1
+
+static power_mgmt_rtc_state *rtc_state(void)
+{
+    static power_mgmt_rtc_state *rtc = NULL;
+    if (rtc == NULL)
     {
-        if (ACTIVE_PINS[i] == pin)
-        {
-            return true;
-        }
+        rtc = rtc_store_claim<power_mgmt_rtc_state, RTC_SLOT_POWER_MGMT>(POWER_MGMT_RTC_STATE_VERSION);
+    }
+    return rtc;
+}
+
+// Pins latched with gpio_hold_en() during this sleep preparation
+static uint64_t held_pins = 0;
+
+// Pull every pin in the mask down as a plain input in one driver call
+static esp_err_t isolate_gpio_mask(uint64_t mask)
+{
+    if (mask == 0)
+    {
+        return ESP_OK;
+    }
+
+    gpio_config_t config = {};
+    config.pin_bit_mask = mask;
+    config.mode = GPIO_MODE_INPUT;
+    config.pull_up_en = GPIO_PULLUP_DISABLE;
+    config.pull_down_en = GPIO_PULLDOWN_ENABLE;
+    config.intr_type = GPIO_INTR_DISABLE;
+    return gpio_config(&config);
+}
+
+// Clock the board booted at: the ceiling for every clock change
+static uint32_t default_cpu_mhz()
+{
+    static uint32_t mhz = 0;
+    if (mhz == 0)
+    {
+        mhz = getCpuFrequencyMhz();
+    }
+    return mhz;
+}
+
+// Let the idle task scale the CPU clock down between bursts of work
+static void configure_frequency_scaling()
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {};
+    pm_config.max_freq_mhz = default_cpu_mhz();
+    pm_config.min_freq_mhz = POWER_MGMT_MIN_CPU_MHZ;
+    pm_config.light_sleep_enable = false; // Needs tickless idle; explicit light sleep in power_mgmt_wait_ms instead
+
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err == ESP_OK)
+    {
+        Serial.print(F("Power management: CPU frequency scaling "));
+        Serial.print(POWER_MGMT_MIN_CPU_MHZ);
+        Serial.print(F("-"));
+        Serial.print(pm_config.max_freq_mhz);
+        Serial.println(F(" MHz"));
+    }
+    else
+    {
+        Serial.print(F("Power management: Warning - frequency scaling unavailable (error: "));
+        Serial.print(err);
+        Serial.println(F(")"));
     }
+#else
+    Serial.println(F("Power management: Frequency scaling not enabled in this framework build"));
+#endif
+}
+
+// Light sleep halts all tasks and USB/UART, and cannot be entered with the radio on
+static bool light_sleep_allowed(uint32_t ms)
+{
+#if ENABLE_SERIAL_CONNECTION
+    (void)ms;
     return false;
+#else
+    return ms >= POWER_MGMT_LIGHT_SLEEP_MIN_MS &&
+           xTaskGetCurrentTaskHandle() == loopTaskHandle &&
+           WiFi.getMode() == WIFI_OFF;
+#endif
+}
+
+void power_mgmt_wait_ms(uint32_t ms)
+{
+    if (!light_sleep_allowed(ms))
+    {
+        delay(ms);
+        return;
+    }
+
+    // Keep the peripheral rail where it is while the digital domain sleeps
+    gpio_num_t periph_power_gpio = (gpio_num_t)PERIPHERAL_POWER_PIN;
+    gpio_hold_en(periph_power_gpio);
+
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+    esp_err_t err = esp_light_sleep_start();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+
+    gpio_hold_dis(periph_power_gpio);
+
+    if (err != ESP_OK)
+    {
+        delay(ms);
+    }
+}
+
+uint32_t power_mgmt_set_cpu_mhz(uint32_t mhz)
+{
+    if (mhz == 0 || mhz > default_cpu_mhz())
+    {
+        mhz = default_cpu_mhz();
+    }
+
+    // WiFi needs the PLL clock; below it the driver stops working
+    if (mhz < POWER_MGMT_RADIO_MIN_CPU_MHZ && WiFi.getMode() != WIFI_OFF)
+    {
+        mhz = POWER_MGMT_RADIO_MIN_CPU_MHZ;
+    }
+
+#if CONFIG_PM_ENABLE
+    // Frequency scaling owns the clock: move its ceiling instead
+    esp_pm_config_t pm_config = {};
+    pm_config.max_freq_mhz = mhz;
+    pm_config.min_freq_mhz = (POWER_MGMT_MIN_CPU_MHZ < mhz) ? POWER_MGMT_MIN_CPU_MHZ : mhz;
+    pm_config.light_sleep_enable = false;
+    if (esp_pm_configure(&pm_config) != ESP_OK)
+    {
+        return getCpuFrequencyMhz();
+    }
+#else
+    if (getCpuFrequencyMhz() != mhz && !setCpuFrequencyMhz(mhz))
+    {
+        return getCpuFrequencyMhz();
+    }
+#endif
+
+    return mhz;
 }
 
-void power_mgmt_post_wakeup(void *context)
+bool power_mgmt_post_wakeup(void *context)
 {
     // Context parameter reserved for future use
     (void)context; // Suppress unused parameter warning
@@ -45,7 +184,30 @@ void power_mgmt_post_wakeup(void *context)
         Serial.println(F(")"));
     }
 
+    // Release any other pins the board descriptor holds
+    for (uint8_t pin = 0; pin < 64; pin++)
+    {
+        if (pin != PERIPHERAL_POWER_PIN && (BOARD_GPIO.hold_mask & (1ULL << pin)))
+        {
+            gpio_hold_dis((gpio_num_t)pin);
+        }
+    }
+
+    const power_mgmt_gpio_audit *audit = &rtc_state()->audit;
+    if (audit->valid && audit->mismatch_count > 0)
+    {
+        Serial.print(F("Power management: WARNING - "));
+        Serial.print(audit->mismatch_count);
+        Serial.print(F(" GPIO(s) were not in their sleep state last sleep (mask 0x"));
+        Serial.print((uint32_t)(audit->mismatch_mask >> 32), HEX);
+        Serial.print((uint32_t)audit->mismatch_mask, HEX);
+        Serial.println(F(")"));
+    }
+
+    configure_frequency_scaling();
+
     Serial.println(F("Power management: post-wakeup complete"));
+    return err == ESP_OK;
 }
 
 static void isolate_uart_usb_pins()
@@ -53,81 +215,86 @@ static void isolate_uart_usb_pins()
     // Flush serial output before isolating UART pins to prevent corruption
     Serial.println(F("Power management: Flushing serial output..."));
     Serial.flush();
-    delay(10);  // Small delay to ensure serial transmission completes
+    power_mgmt_wait_ms(10);  // Small delay to ensure serial transmission completes
 
-    // Isolate UART pins to prevent floating during sleep
-    pinMode(UART_TX_PIN, INPUT_PULLDOWN);
-    pinMode(UART_RX_PIN, INPUT_PULLDOWN);
-
-    // Isolate USB pins (USB already disabled via btStop(), but prevent floating)
-    pinMode(USB_DM_PIN, INPUT_PULLDOWN);
-    pinMode(USB_DP_PIN, INPUT_PULLDOWN);
+    // Isolate UART and USB pins (USB already disabled via btStop(), but prevent floating)
+    isolate_gpio_mask(BOARD_GPIO.console_mask);
 
     // Note: Serial output unavailable after this point due to pin isolation
 }
 
-static void isolate_i2c_pins()
-{
-    // After Wire.end() is called, I2C pins should be isolated to prevent floating
-    // I2C pins are in ACTIVE_PINS during normal operation but need isolation for sleep
-    pinMode(I2C_SDA_PIN, INPUT_PULLDOWN);
-    pinMode(I2C_SCL_PIN, INPUT_PULLDOWN);
-}
-
 static void isolate_unused_gpios()
 {
-    // Isolate all other GPIOs not actively used
+    // Isolate every GPIO that is not reserved or driven by the application,
+    // including the wake-only I2C and board LED pins (after Wire.end() has been called).
+    // The mask is computed and checked at compile time (board_gpio_config.h).
     // This prevents floating inputs from causing current leakage
+    constexpr uint64_t mask = BOARD_GPIO.isolate_mask();
 
     Serial.println(F("Power management: Isolating unused GPIO pins..."));
 
-    int isolated_count = 0;
-
-    // ESP32-C6 has GPIOs 0-30, ESP32-S3 has GPIOs 0-48
-    // We'll iterate through a safe range and skip active pins
-    #if defined(BOARD_TYPE_ESP32C6)
-        const uint8_t MAX_GPIO = 30;
-    #elif defined(BOARD_TYPE_ESP32S3)
-        const uint8_t MAX_GPIO = 48;
-    #else
-        const uint8_t MAX_GPIO = 39;  // Safe fallback
-    #endif
+    esp_err_t err = isolate_gpio_mask(mask);
 
-    for (uint8_t pin = 0; pin <= MAX_GPIO; pin++)
+    if (err == ESP_OK)
     {
-        // Skip pins that are actively used or already handled
-        if (is_active_pin(pin))
-        {
-            continue;
-        }
-
-        // Skip UART and USB pins (handled separately above)
-        if (pin == UART_TX_PIN || pin == UART_RX_PIN ||
-            pin == USB_DM_PIN || pin == USB_DP_PIN)
-        {
-            continue;
-        }
-
-        // Set unused GPIO to INPUT_PULLDOWN to prevent floating
-        pinMode(pin, INPUT_PULLDOWN);
-        isolated_count++;
+        Serial.print(F("Power management: Isolated "));
+        Serial.print(__builtin_popcountll(mask));
+        Serial.println(F(" GPIO pins"));
     }
+    else
+    {
+        Serial.print(F("Power management: ERROR - GPIO isolation failed (error: "));
+        Serial.print(err);
+        Serial.println(F(")"));
+    }
+}
 
-    Serial.print(F("Power management: Isolated "));
-    Serial.print(isolated_count);
-    Serial.println(F(" unused GPIO pins"));
+static void pull_down_application_gpios()
+{
+    // Modules pull their own pins down in their sleep callbacks, but a stage
+    // left out of the wake profile never gets that callback. Pulling the
+    // non-held application pins down here covers every profile (and is a
+    // no-op for pins their module already released).
+    constexpr uint64_t mask = BOARD_GPIO.application_pulldown_mask();
+
+    esp_err_t err = isolate_gpio_mask(mask);
+    if (err != ESP_OK)
+    {
+        Serial.print(F("Power management: ERROR - application GPIO pull-down failed (error: "));
+        Serial.print(err);
+        Serial.println(F(")"));
+    }
 }
 
 static void enable_peripheral_power_hold()
 {
     // Enable GPIO hold on peripheral power pin to maintain OFF state during sleep
     // This is critical - without hold, the pin may float and peripherals could power on
+    static_assert(BOARD_GPIO.hold_mask & gpio_mask(PERIPHERAL_POWER_PIN),
+                  "Peripheral power pin must be in the board's hold mask");
+
+    // Latch any other pins the board descriptor holds
+    for (uint8_t pin = 0; pin < 64; pin++)
+    {
+        if (pin != PERIPHERAL_POWER_PIN && (BOARD_GPIO.hold_mask & (1ULL << pin)) &&
+            gpio_hold_en((gpio_num_t)pin) == ESP_OK)
+        {
+            held_pins |= (1ULL << pin);
+        }
+    }
+
+    // Drive the rail OFF before latching it: a profile that leaves out the
+    // peripheral power stage never runs peripheral_power_off(), and holding
+    // the pin in its reset state would let the rail float
+    pinMode(PERIPHERAL_POWER_PIN, OUTPUT);
+    digitalWrite(PERIPHERAL_POWER_PIN, PERIPHERAL_POWER_OFF_STATE);
 
     gpio_num_t periph_power_gpio = (gpio_num_t)PERIPHERAL_POWER_PIN;
     esp_err_t err = gpio_hold_en(periph_power_gpio);
 
     if (err == ESP_OK)
     {
+        held_pins |= gpio_mask(PERIPHERAL_POWER_PIN);
         Serial.print(F("Power management: Enabled GPIO hold on peripheral power pin "));
         Serial.println(PERIPHERAL_POWER_PIN);
 
@@ -148,6 +315,49 @@ static void enable_peripheral_power_hold()
     }
 }
 
+// Snapshot every GPIO and compare it with the board descriptor's expected sleep state.
+// Runs after the console pins are isolated, so it must not print.
+static void audit_sleep_gpios()
+{
+    power_mgmt_gpio_audit audit = {};
+    uint8_t packed[BOARD_GPIO_COUNT];
+
+    for (uint8_t pin = 0; pin < BOARD_GPIO_COUNT; pin++)
+    {
+        gpio_io_config_t io = {};
+        gpio_pin_state state = {};
+        if (gpio_get_io_config((gpio_num_t)pin, &io) == ESP_OK)
+        {
+            state.input_enabled = io.ie;
+            state.output_enabled = io.oe;
+            state.pull_up = io.pu;
+            state.pull_down = io.pd;
+        }
+        state.held = (held_pins & (1ULL << pin)) != 0;
+        // Arduino's OUTPUT mode keeps the input path enabled, so this reads back the latched level
+        state.level = gpio_get_level((gpio_num_t)pin) != 0;
+
+        packed[pin] = gpio_audit_pack(&state);
+        if (!gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(pin), &state))
+        {
+            audit.mismatch_mask |= (1ULL << pin);
+            audit.mismatch_count++;
+        }
+    }
+
+    audit.digest = esp_rom_crc32_le(0, packed, sizeof(packed));
+    audit.valid = true;
+
+    // Sealed by BoardLifecycle just before deep sleep
+    rtc_state()->audit = audit;
+}
+
+bool power_mgmt_get_gpio_audit(power_mgmt_gpio_audit *audit)
+{
+    *audit = rtc_state()->audit;
+    return audit->valid;
+}
+
 void power_mgmt_prep_sleep(void *context)
 {
     // Context parameter reserved for future use
@@ -158,36 +368,34 @@ void power_mgmt_prep_sleep(void *context)
     // Step 1: Shut down Bluetooth radio
     Serial.println(F("Power management: Shutting down Bluetooth..."));
     btStop();
-    delay(100); // Allow time for Bluetooth to shutdown
+    power_mgmt_wait_ms(100); // Allow time for Bluetooth to shutdown
 
     // Step 2: Configure ESP32 power domains for deep sleep
     Serial.println(F("Power management: Configuring ESP32 power domains..."));
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_OFF);
     esp_sleep_pd_config(ESP_PD_DOMAIN_XTAL, ESP_PD_OPTION_OFF);
 
-    // Step 3: Isolate board LED pin
-    #ifdef BOARD_LED_PIN
-    pinMode(BOARD_LED_PIN, INPUT_PULLDOWN);
-    Serial.print(F("Power management: Board LED pin "));
-    Serial.print(BOARD_LED_PIN);
-    Serial.println(F(" set to INPUT_PULLDOWN"));
-    #endif
-
-    // Step 4: Isolate I2C pins (after Wire.end() has been called)
-    Serial.println(F("Power management: Isolating I2C pins..."));
-    isolate_i2c_pins();
+#if FAST_BOOT
+    // The ROM boot log costs milliseconds of UART output on every wake
+    esp_deep_sleep_disable_rom_logging();
+#endif
 
-    // Step 5: Isolate all other unused GPIOs
+    // Step 3: Isolate all unused GPIOs, board LED and I2C pins in one pass,
+    // then the application pins that are not held
     isolate_unused_gpios();
+    pull_down_application_gpios();
 
-    // Step 6: Enable GPIO hold on peripheral power pin
-    // This must be done AFTER peripheral_power_off() has been called
+    // Step 4: Drive the peripheral power pin OFF and enable GPIO hold on it
+    // (whether or not the profile ran peripheral_power_off())
     // Note: GPIO hold may not work on non-RTC GPIOs during deep sleep
     enable_peripheral_power_hold();
 
-    // Step 7: Isolate UART and USB pins (must be last - disables Serial output)
+    // Step 5: Isolate UART and USB pins (must be last - disables Serial output)
     isolate_uart_usb_pins();
 
+    // Step 6: Record what every pin actually ended up as
+    audit_sleep_gpios();
+
     // Serial output unavailable after this point
 }
 
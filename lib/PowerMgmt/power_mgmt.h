@@ -15,8 +15,25 @@
  * - GPIO hold for peripheral power control
  * - UART and USB pin isolation
  * - Integration with existing power management (BatteryMonitor, StatusLed, SoilSensor)
+ * - Low-power blocking waits (power_mgmt_wait_ms) for all modules
+ * - Pre-sleep GPIO audit against the board descriptor, kept for the next wake
  */
 
+// Waits at least this long may use light sleep (shorter ones are not worth the entry/exit cost)
+#ifndef POWER_MGMT_LIGHT_SLEEP_MIN_MS
+#define POWER_MGMT_LIGHT_SLEEP_MIN_MS 20
+#endif
+
+// Lowest CPU frequency for dynamic frequency scaling while idle (MHz)
+#ifndef POWER_MGMT_MIN_CPU_MHZ
+#define POWER_MGMT_MIN_CPU_MHZ 40
+#endif
+
+// Lowest CPU clock while WiFi is on (MHz); the radio needs the PLL
+#ifndef POWER_MGMT_RADIO_MIN_CPU_MHZ
+#define POWER_MGMT_RADIO_MIN_CPU_MHZ 80
+#endif
+
 /**
  * Initialize power management system.
  * Should be called once in setup() after peripheral_power_on().
@@ -24,10 +41,38 @@
  * Performs post-wakeup cleanup:
  * - Releases GPIO hold states from previous sleep cycle
  * - Prepares GPIO subsystem for normal operation
+ * - Enables dynamic CPU frequency scaling (if the framework supports it)
  *
  * @param context Optional context pointer (currently unused, reserved for future use)
+ * @return true if the peripheral power pin hold was released
+ */
+bool power_mgmt_post_wakeup(void *context);
+
+/**
+ * Block the calling task for a while at the lowest safe power.
+ * Use instead of delay() for settle times, back-offs and pacing.
+ *
+ * - Short waits, waits with the radio on and waits on tasks other than the
+ *   loop task use vTaskDelay: the idle task then lets power management drop
+ *   the CPU clock (and the WiFi driver modem-sleep) while waiting.
+ * - Longer waits on the loop task with the radio off (and Serial disabled)
+ *   enter light sleep, holding the peripheral power pin in its state.
+ *
+ * Light sleep stops every task, so it is never used from lifecycle stage tasks.
+ *
+ * @param ms Time to wait in milliseconds
+ */
+void power_mgmt_wait_ms(uint32_t ms);
+
+/**
+ * Switch the CPU clock (e.g. per lifecycle stage, see board_lifecycle_set_clock_handler()).
+ * Requests are clamped to the boot clock, and to POWER_MGMT_RADIO_MIN_CPU_MHZ
+ * while WiFi is on. With frequency scaling enabled the scaling ceiling moves instead.
+ *
+ * @param mhz Requested clock (a supported frequency), 0 for the boot clock
+ * @return Clock applied (MHz)
  */
-void power_mgmt_post_wakeup(void *context);
+uint32_t power_mgmt_set_cpu_mhz(uint32_t mhz);
 
 /**
  * Prepare all GPIOs and peripherals for deep sleep.
@@ -41,11 +86,31 @@ void power_mgmt_post_wakeup(void *context);
  * - Isolates unused GPIOs
  * - Enables GPIO hold on peripheral power pin
  * - Isolates UART and USB pins (disables Serial output)
+ * - Audits the final state of every GPIO (see power_mgmt_get_gpio_audit())
  *
  * @param context Optional context pointer (currently unused, reserved for future use)
  */
 void power_mgmt_prep_sleep(void *context);
 
+/**
+ * Result of the GPIO audit taken at the end of sleep preparation.
+ */
+typedef struct
+{
+    bool valid;             // An audit ran before the last deep sleep
+    uint32_t digest;        // CRC32 over the packed state of every GPIO (changes when any pin does)
+    uint64_t mismatch_mask; // GPIOs not in their expected sleep state (bit n = GPIOn)
+    uint8_t mismatch_count;
+} power_mgmt_gpio_audit;
+
+/**
+ * Get the GPIO audit taken before the last deep sleep.
+ *
+ * @param audit Output: audit result
+ * @return true if an audit is available (not after a cold boot)
+ */
+bool power_mgmt_get_gpio_audit(power_mgmt_gpio_audit *audit);
+
 /**
  * Emergency sleep preparation with minimal cleanup.
  * Used when WiFi connection fails and system needs to sleep immediately.
@@ -3,6 +3,8 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <wifi_conn.h> // For WiFi shutdown in disconnect
+#include <power_mgmt.h>
+#include <board_lifecycle.h>
 
 // Fallback version definitions if build script doesn't run
 #ifndef BUILD_SW_VERSION
@@ -26,8 +28,11 @@ static const char *DEFAULT_MQTT_PASS = "";
 #define MQTT_KEEPALIVE_SEC 30
 #define MQTT_CONNECT_MAX_RETRIES 25
 #define MQTT_CONNECT_RETRY_DELAY_MS 2000
+#define MQTT_SOCKET_TIMEOUT_S 5 // A broker that accepts TCP but never answers must not eat the stage deadline
 #define MQTT_DISCONNECT_LOOP_COUNT 10
 #define MQTT_DISCONNECT_LOOP_DELAY_MS 200
+#define MQTT_MAX_SUBSCRIPTIONS 4
+#define MQTT_MAX_TOPIC_LENGTH 96
 
 WiFiClient wifiClient;
 PubSubClient pubsubClient(wifiClient);
@@ -35,6 +40,18 @@ PubSubClient pubsubClient(wifiClient);
 // Flag to track if autodiscovery messages have been published
 static bool autodisco_published = false;
 
+// Queued messages already delivered by pubsub_drain() on this connection
+static bool drained = false;
+
+typedef struct
+{
+    char topic[MQTT_MAX_TOPIC_LENGTH];
+    pubsub_message_handler handler;
+} pubsub_subscription;
+
+static pubsub_subscription subscriptions[MQTT_MAX_SUBSCRIPTIONS];
+static uint8_t subscription_count = 0;
+
 String get_client_id()
 {
     uint8_t mac[6];
@@ -67,14 +84,19 @@ void setup_pubsub()
     return;
 }
 
-bool connect_pubsub()
+// Connect to the configured broker, retrying until MQTT_CONNECT_MAX_RETRIES or the
+// lifecycle stage runs out of time (it is abandoned at its deadline, never killed)
+static bool connect_with_retries(const char *user, const char *pass)
 {
-    // DEPRECATED: Use pubsub_connect() with context parameter instead
-    Serial.println(F("WARNING: connect_pubsub() is deprecated, use pubsub_connect() with context"));
-
     int attempts = 0;
     while (!pubsubClient.connected() && attempts < MQTT_CONNECT_MAX_RETRIES)
     {
+        if (board_lifecycle_stage_remaining_ms() == 0)
+        {
+            Serial.println(F("MQTT: Out of time, giving up"));
+            return false;
+        }
+
         String clientID = get_client_id();
         Serial.print(F("Connecting to MQTT as: "));
         Serial.println(clientID);
@@ -83,7 +105,7 @@ bool connect_pubsub()
         String availabilityTopic = get_mqtt_topic(AVAILABILITY_MQTT_TOPIC);
         const char *willPayload = "offline";
         // QoS 0 (PubSubClient), retain true so HA sees offline if we drop
-        if (pubsubClient.connect(clientID.c_str(), DEFAULT_MQTT_USER, DEFAULT_MQTT_PASS,
+        if (pubsubClient.connect(clientID.c_str(), user, pass,
                                  availabilityTopic.c_str(), 0, true, willPayload))
         {
             Serial.println(F("Connected to MQTT"));
@@ -93,14 +115,14 @@ bool connect_pubsub()
             pubsubClient.loop();
             return true;
         }
-        else
-        {
-            Serial.print(F("MQTT connection failed, rc="));
-            Serial.print(pubsubClient.state());
-            Serial.println(F(" retrying..."));
-            attempts++;
-            delay(MQTT_CONNECT_RETRY_DELAY_MS);
-        }
+
+        Serial.print(F("MQTT connection failed, rc="));
+        Serial.print(pubsubClient.state());
+        Serial.println(F(" retrying..."));
+        attempts++;
+
+        uint32_t remaining_ms = board_lifecycle_stage_remaining_ms();
+        power_mgmt_wait_ms((remaining_ms < MQTT_CONNECT_RETRY_DELAY_MS) ? remaining_ms : MQTT_CONNECT_RETRY_DELAY_MS);
     }
 
     if (!pubsubClient.connected())
@@ -108,8 +130,15 @@ bool connect_pubsub()
         Serial.println(F("Failed to connect to MQTT after multiple attempts"));
         return false;
     }
+    return true;
+}
 
-    return false;
+bool connect_pubsub()
+{
+    // DEPRECATED: Use pubsub_connect() with context parameter instead
+    Serial.println(F("WARNING: connect_pubsub() is deprecated, use pubsub_connect() with context"));
+
+    return connect_with_retries(DEFAULT_MQTT_USER, DEFAULT_MQTT_PASS);
 }
 
 bool pubsub_connect(void *context)
@@ -138,46 +167,9 @@ bool pubsub_connect(void *context)
     pubsubClient.setServer(broker, port);
     pubsubClient.setBufferSize(MQTT_BUFFER_SIZE);
     pubsubClient.setKeepAlive(MQTT_KEEPALIVE_SEC);
+    pubsubClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
 
-    // Connect to broker (same logic as connect_pubsub)
-    int attempts = 0;
-    while (!pubsubClient.connected() && attempts < MQTT_CONNECT_MAX_RETRIES)
-    {
-        String clientID = get_client_id();
-        Serial.print(F("Connecting to MQTT as: "));
-        Serial.println(clientID);
-
-        // Set Last Will and Testament (LWT) on availability topic
-        String availabilityTopic = get_mqtt_topic(AVAILABILITY_MQTT_TOPIC);
-        const char *willPayload = "offline";
-
-        if (pubsubClient.connect(clientID.c_str(), user, pass,
-                                 availabilityTopic.c_str(), 0, true, willPayload))
-        {
-            Serial.println(F("Connected to MQTT"));
-            // Publish 'online' availability
-            pubsubClient.publish(availabilityTopic.c_str(), "online", true);
-            publish_autodisco_messages();
-            pubsubClient.loop();
-            return true;
-        }
-        else
-        {
-            Serial.print(F("MQTT connection failed, rc="));
-            Serial.print(pubsubClient.state());
-            Serial.println(F(" retrying..."));
-            attempts++;
-            delay(MQTT_CONNECT_RETRY_DELAY_MS);
-        }
-    }
-
-    if (!pubsubClient.connected())
-    {
-        Serial.println(F("Failed to connect to MQTT after multiple attempts"));
-        return false;
-    }
-
-    return false;
+    return connect_with_retries(user, pass);
 }
 
 void publish_autodisco_messages()
@@ -211,7 +203,7 @@ void publish_autodisco_messages()
     payload += availabilityJson;
     payload += deviceJson + "}";
     bool ok = pubsubClient.publish(configTopic.c_str(), payload.c_str(), true);
-    delay(100);
+    power_mgmt_wait_ms(100);
     if (!ok)
     {
         Serial.println("WARN: Failed to publish soil moisture discovery config (likely buffer too small)");
@@ -239,7 +231,7 @@ void publish_autodisco_messages()
     payload += availabilityJson;
     payload += deviceJson + "}";
     ok &= pubsubClient.publish(configTopic.c_str(), payload.c_str(), true);
-    delay(100);
+    power_mgmt_wait_ms(100);
     if (!ok)
     {
         Serial.println("WARN: Failed to publish soil raw discovery config");
@@ -268,7 +260,7 @@ void publish_autodisco_messages()
     payload += availabilityJson;
     payload += deviceJson + "}";
     ok &= pubsubClient.publish(configTopic.c_str(), payload.c_str(), true);
-    delay(100);
+    power_mgmt_wait_ms(100);
     if (!ok)
     {
         Serial.println("WARN: Failed to publish battery percentage discovery config");
@@ -299,7 +291,7 @@ void publish_autodisco_messages()
     payload += availabilityJson;
     payload += deviceJson + "}";
     ok &= pubsubClient.publish(configTopic.c_str(), payload.c_str(), true);
-    delay(100);
+    power_mgmt_wait_ms(100);
     if (!ok)
     {
         Serial.println("WARN: Failed to publish battery voltage discovery config");
@@ -329,7 +321,7 @@ void publish_autodisco_messages()
     payload += availabilityJson;
     payload += deviceJson + "}";
     ok &= pubsubClient.publish(configTopic.c_str(), payload.c_str(), true);
-    delay(100);
+    power_mgmt_wait_ms(100);
     if (!ok)
     {
         Serial.println("WARN: Failed to publish battery change rate discovery config");
@@ -346,7 +338,7 @@ void publish_autodisco_messages()
     // ----------------------------------------
 
     pubsubClient.loop();
-    delay(500);
+    power_mgmt_wait_ms(500);
 
     // Mark autodiscovery as published
     autodisco_published = ok;
@@ -355,12 +347,7 @@ void publish_autodisco_messages()
 
 bool publish_pub_sub_message(const char *topic, const char *payload)
 {
-    // attempt connection rescue if not connected
-    if (!pubsubClient.connected())
-    {
-        connect_pubsub();
-    }
-
+    // No reconnect here: that belongs to pubsub_connect(), bounded by its stage deadline
     // Ensure autodiscovery has been published before publishing state messages
     if (pubsubClient.connected() && !autodisco_published)
     {
@@ -392,22 +379,78 @@ bool publish_pub_sub_message(const char *topic, const char *payload)
     return false;
 }
 
+static void dispatch_message(char *topic, uint8_t *payload, unsigned int length)
+{
+    for (uint8_t i = 0; i < subscription_count; i++)
+    {
+        if (strcmp(subscriptions[i].topic, topic) == 0)
+        {
+            subscriptions[i].handler(topic, payload, length);
+        }
+    }
+}
+
+bool pubsub_subscribe(const char *topic, pubsub_message_handler handler)
+{
+    if (!pubsubClient.connected() || strlen(topic) >= MQTT_MAX_TOPIC_LENGTH)
+    {
+        return false;
+    }
+
+    uint8_t i = 0;
+    while (i < subscription_count && strcmp(subscriptions[i].topic, topic) != 0)
+    {
+        i++;
+    }
+    if (i == subscription_count)
+    {
+        if (subscription_count == MQTT_MAX_SUBSCRIPTIONS)
+        {
+            Serial.println(F("MQTT: Too many subscriptions"));
+            return false;
+        }
+        strcpy(subscriptions[i].topic, topic);
+        subscription_count++;
+    }
+    subscriptions[i].handler = handler;
+
+    pubsubClient.setCallback(dispatch_message);
+    return pubsubClient.subscribe(topic);
+}
+
+bool pubsub_service()
+{
+    return pubsubClient.loop();
+}
+
+void pubsub_drain()
+{
+    if (!pubsubClient.connected() || drained)
+    {
+        return;
+    }
+
+    for (int i = 0; i < MQTT_DISCONNECT_LOOP_COUNT; i++)
+    {
+        pubsubClient.loop();
+        power_mgmt_wait_ms(MQTT_DISCONNECT_LOOP_DELAY_MS);
+    }
+    drained = true;
+}
+
 void disconnect_pubsub()
 {
     if (pubsubClient.connected())
     {
         // Process any remaining MQTT messages
-        for (int i = 0; i < MQTT_DISCONNECT_LOOP_COUNT; i++)
-        {
-            pubsubClient.loop();
-            delay(MQTT_DISCONNECT_LOOP_DELAY_MS);
-        }
+        pubsub_drain();
 
         Serial.println(F("Disconnecting from MQTT gracefully..."));
         pubsubClient.disconnect();
-        delay(100);
+        power_mgmt_wait_ms(100);
         // Reset autodiscovery published flag on disconnect
         autodisco_published = false;
+        drained = false;
     }
     else
     {
@@ -415,10 +458,18 @@ void disconnect_pubsub()
     }
 }
 
+void pubsub_stop(void *context)
+{
+    // Context parameter reserved for future use
+    (void)context; // Suppress unused parameter warning
+
+    disconnect_pubsub();
+}
+
 void pubsub_disconnect(void *context)
 {
     // Disconnect from MQTT first
-    disconnect_pubsub();
+    pubsub_stop(context);
 
     // Then shutdown WiFi (MQTT requires WiFi, so turn it off too)
     wifi_conn_stop(context);
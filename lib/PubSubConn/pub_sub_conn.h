@@ -29,6 +29,50 @@ bool pubsub_connect(void *context);
 void publish_autodisco_messages();
 bool publish_pub_sub_message(const char *topic, const char *payload);
 
+/**
+ * Handler for messages on a subscribed topic.
+ *
+ * @param topic Topic the message arrived on
+ * @param payload Message payload (not null-terminated)
+ * @param length Payload length in bytes
+ */
+typedef void (*pubsub_message_handler)(const char *topic, const uint8_t *payload, unsigned int length);
+
+/**
+ * Subscribe to a topic, e.g. a retained per-device setting. Messages are
+ * delivered from pubsub_service() and while disconnecting, so a retained
+ * value arrives before the wake ends.
+ *
+ * @param topic Topic to subscribe to (no wildcards; copied)
+ * @param handler Called for each message on the topic
+ * @return true if the subscription was sent
+ */
+bool pubsub_subscribe(const char *topic, pubsub_message_handler handler);
+
+/**
+ * Service the MQTT connection (keepalive, incoming packets) while staying awake
+ * between publishes. Call at least once per keepalive interval.
+ *
+ * @return true while connected to the broker
+ */
+bool pubsub_service();
+
+/**
+ * Deliver the messages still queued on the broker connection (subscriptions)
+ * now rather than while disconnecting. The next disconnect skips its own drain.
+ * No-op while disconnected.
+ */
+void pubsub_drain();
+
+/**
+ * Disconnect from MQTT broker, leaving WiFi up.
+ * Processes pending messages before disconnecting gracefully.
+ * Use as the sleep counterpart of pubsub_connect() when WiFi is stopped separately.
+ *
+ * @param context Optional context pointer (currently unused, reserved for future use)
+ */
+void pubsub_stop(void *context);
+
 /**
  * Disconnect from MQTT broker and shut down WiFi.
  * Processes pending messages before disconnecting gracefully.
@@ -0,0 +1,106 @@
+#include "readiness.h"
+#include <power_mgmt.h>
+#include <rtc_store.h>
+
+typedef struct
+{
+    readiness_stats stats[READINESS_SIGNAL_COUNT];
+} readiness_rtc_state;
+
+#define READINESS_RTC_STATE_VERSION 1
+
+static readiness_rtc_state *rtc_state(void)
+{
+    static readiness_rtc_state *rtc = NULL;
+    if (rtc == NULL)
+    {
+        rtc = rtc_store_claim<readiness_rtc_state, RTC_SLOT_READINESS>(READINESS_RTC_STATE_VERSION);
+    }
+    return rtc;
+}
+
+static const char *const signal_names[READINESS_SIGNAL_COUNT] = {
+    "soil_adc",
+    "fuel_gauge",
+    "cell_voltage",
+};
+
+const char *readiness_signal_name(readiness_signal signal)
+{
+    return (signal < READINESS_SIGNAL_COUNT) ? signal_names[signal] : "unknown";
+}
+
+bool readiness_wait(readiness_signal signal, readiness_probe probe, void *context, uint32_t timeout_ms)
+{
+    unsigned long start = millis();
+    bool ready = probe(context);
+    while (!ready && millis() - start < timeout_ms)
+    {
+        power_mgmt_wait_ms(READINESS_POLL_MS);
+        ready = probe(context);
+    }
+    uint32_t elapsed = millis() - start;
+
+    Serial.print(F("Readiness: "));
+    Serial.print(readiness_signal_name(signal));
+    Serial.print(ready ? F(" ready after ") : F(" NOT ready after "));
+    Serial.print(elapsed);
+    Serial.println(F("ms"));
+
+    if (signal < READINESS_SIGNAL_COUNT)
+    {
+        readiness_stats *stats = &rtc_state()->stats[signal];
+        if (ready)
+        {
+            stats->last_ms = elapsed;
+            stats->max_ms = (elapsed > stats->max_ms) ? elapsed : stats->max_ms;
+            if (stats->samples < UINT16_MAX)
+            {
+                stats->samples++;
+            }
+        }
+        else if (stats->timeouts < UINT16_MAX)
+        {
+            stats->timeouts++;
+        }
+        rtc_store_commit_slot(RTC_SLOT_READINESS);
+    }
+
+    return ready;
+}
+
+bool readiness_get_stats(readiness_signal signal, readiness_stats *stats)
+{
+    if (signal >= READINESS_SIGNAL_COUNT)
+    {
+        return false;
+    }
+    *stats = rtc_state()->stats[signal];
+    return true;
+}
+
+void readiness_adc_probe_init(readiness_adc_probe *probe, uint8_t pin, uint16_t tolerance)
+{
+    probe->pin = pin;
+    probe->tolerance = tolerance;
+    probe->last_raw = -1;
+    probe->stable_count = 0;
+}
+
+bool readiness_adc_settled(void *context)
+{
+    readiness_adc_probe *probe = (readiness_adc_probe *)context;
+
+    int raw = analogRead(probe->pin);
+    if (probe->last_raw >= 0 && abs(raw - probe->last_raw) <= probe->tolerance)
+    {
+        probe->stable_count++;
+    }
+    else
+    {
+        probe->stable_count = 1;
+    }
+    probe->last_raw = raw;
+
+    return probe->stable_count >= READINESS_ADC_STABLE_SAMPLES;
+}
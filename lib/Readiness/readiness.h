@@ -0,0 +1,101 @@
+#ifndef READINESS_H
+#define READINESS_H
+
+#include <Arduino.h>
+
+/**
+ * Peripheral Readiness
+ *
+ * Replaces fixed settle delays after power-up with polling of a real
+ * readiness signal (ADC readings settled, fuel gauge answering, valid cell
+ * voltage) under a bounded timeout. The measured time-to-ready of every
+ * signal is kept across wakes in RTC memory so timeouts can be tuned per
+ * board from the logs.
+ */
+
+// Interval between probes (ms)
+#ifndef READINESS_POLL_MS
+#define READINESS_POLL_MS 5
+#endif
+
+/**
+ * Signals with recorded time-to-ready. Append only (RTC layout).
+ */
+typedef enum
+{
+    READINESS_SOIL_ADC = 0,  // Soil sensor output settled (successive ADC samples within tolerance)
+    READINESS_FUEL_GAUGE,    // MAX17048 answering on I2C
+    READINESS_CELL_VOLTAGE,  // MAX17048 reporting a valid VCELL and a first SOC estimate
+    READINESS_SIGNAL_COUNT
+} readiness_signal;
+
+/**
+ * Probe for a readiness signal.
+ *
+ * @param context Probe-specific state
+ * @return true once the hardware is ready
+ */
+typedef bool (*readiness_probe)(void *context);
+
+/**
+ * Measured time-to-ready of one signal (since power-on).
+ */
+typedef struct
+{
+    uint32_t last_ms;  // This wake (or the latest wake that waited)
+    uint32_t max_ms;   // Slowest ready seen
+    uint16_t samples;  // Waits that became ready
+    uint16_t timeouts; // Waits that gave up
+} readiness_stats;
+
+/**
+ * Poll a probe until it reports ready or the timeout expires.
+ * Callers proceed either way; a timeout only means the reading may be off.
+ *
+ * @param signal Signal being waited for (stats slot)
+ * @param probe Probe, called immediately and then every READINESS_POLL_MS
+ * @param context Passed to the probe
+ * @param timeout_ms Give up after this long (the old fixed delay is a safe value)
+ * @return true if the probe reported ready in time
+ */
+bool readiness_wait(readiness_signal signal, readiness_probe probe, void *context, uint32_t timeout_ms);
+
+/**
+ * Get the time-to-ready stats of a signal.
+ *
+ * @return false if signal is out of range
+ */
+bool readiness_get_stats(readiness_signal signal, readiness_stats *stats);
+
+/**
+ * Name of a signal, for logs and diagnostics.
+ */
+const char *readiness_signal_name(readiness_signal signal);
+
+/**
+ * ADC settle probe state: ready once READINESS_ADC_STABLE_SAMPLES successive
+ * samples differ by no more than tolerance.
+ */
+#ifndef READINESS_ADC_STABLE_SAMPLES
+#define READINESS_ADC_STABLE_SAMPLES 3
+#endif
+
+typedef struct
+{
+    uint8_t pin;
+    uint16_t tolerance;  // Max difference between successive raw samples
+    int last_raw;        // -1 before the first sample
+    uint8_t stable_count;
+} readiness_adc_probe;
+
+/**
+ * Initialize an ADC settle probe.
+ */
+void readiness_adc_probe_init(readiness_adc_probe *probe, uint8_t pin, uint16_t tolerance);
+
+/**
+ * readiness_probe for an ADC pin (context: readiness_adc_probe *).
+ */
+bool readiness_adc_settled(void *context);
+
+#endif // READINESS_H
@@ -0,0 +1,154 @@
+#include "rtc_store.h"
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+#include <freertos/FreeRTOS.h>
+
+#define RTC_STORE_MAGIC 0x52544353 // "RTCS"
+
+typedef struct
+{
+    uint16_t version;
+    uint16_t size;
+    uint32_t crc;
+} rtc_slot_header;
+
+// Byte offset of each slot in the data area (header + capacity, in slot order)
+static constexpr size_t slot_offset(uint8_t slot)
+{
+    return (slot == 0) ? 0 : slot_offset(slot - 1) + sizeof(rtc_slot_header) + rtc_store_slot_capacity[slot - 1];
+}
+
+static constexpr size_t RTC_STORE_DATA_SIZE = slot_offset(RTC_STORE_SLOT_COUNT);
+
+static constexpr bool slot_capacities_aligned(uint8_t slot = 0)
+{
+    return slot == RTC_STORE_SLOT_COUNT || (rtc_store_slot_capacity[slot] % 4 == 0 && slot_capacities_aligned(slot + 1));
+}
+
+static_assert(slot_capacities_aligned(), "RTC store slot capacities must be multiples of 4");
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t schema_version;
+    uint32_t data[RTC_STORE_DATA_SIZE / 4];
+} rtc_store_area;
+
+// Not initialized by the bootloader: survives deep sleep and software resets,
+// validated by magic / version / CRC instead
+RTC_NOINIT_ATTR static rtc_store_area store;
+
+// Guards the store check, slot claims and claimed_slots: stages claim their
+// slots from concurrent tasks, possibly on both cores
+static portMUX_TYPE store_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool store_checked = false;
+static uint32_t claimed_slots = 0;
+
+static rtc_slot_header *slot_header(rtc_store_slot slot)
+{
+    return (rtc_slot_header *)((uint8_t *)store.data + slot_offset(slot));
+}
+
+static uint8_t *slot_data(rtc_store_slot slot)
+{
+    return (uint8_t *)(slot_header(slot) + 1);
+}
+
+// Validate the store once per boot; discard it on cold boot, brownout or schema change.
+// Called with store_lock held; returns true if the store was discarded.
+static bool check_store(void)
+{
+    if (store_checked)
+    {
+        return false;
+    }
+    store_checked = true;
+
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool cold_boot = (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT);
+
+    if (!cold_boot && store.magic == RTC_STORE_MAGIC && store.schema_version == RTC_STORE_SCHEMA_VERSION)
+    {
+        return false;
+    }
+
+    memset(&store, 0, sizeof(store));
+    store.magic = RTC_STORE_MAGIC;
+    store.schema_version = RTC_STORE_SCHEMA_VERSION;
+    return true;
+}
+
+// Recompute a claimed slot's CRC. Called with store_lock held.
+static void seal_slot(rtc_store_slot slot)
+{
+    if (!(claimed_slots & (1UL << slot)))
+    {
+        return;
+    }
+
+    rtc_slot_header *header = slot_header(slot);
+    header->crc = esp_rom_crc32_le(0, slot_data(slot), header->size);
+}
+
+void *rtc_store_claim(rtc_store_slot slot, uint16_t version, uint16_t size, bool *fresh)
+{
+    if (slot >= RTC_STORE_SLOT_COUNT || size > rtc_store_slot_capacity[slot])
+    {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL(&store_lock);
+    bool discarded = check_store();
+
+    rtc_slot_header *header = slot_header(slot);
+    uint8_t *data = slot_data(slot);
+    bool is_fresh = false;
+
+    // A slot claimed twice in one wake is already live
+    if (!(claimed_slots & (1UL << slot)))
+    {
+        if (header->version != version || header->size != size || header->crc != esp_rom_crc32_le(0, data, size))
+        {
+            memset(data, 0, rtc_store_slot_capacity[slot]);
+            header->version = version;
+            header->size = size;
+            is_fresh = true;
+        }
+        claimed_slots |= (1UL << slot);
+        seal_slot(slot);
+    }
+    taskEXIT_CRITICAL(&store_lock);
+
+    if (discarded)
+    {
+        Serial.println(F("RtcStore: No valid state (cold boot or schema change), starting fresh"));
+    }
+
+    if (fresh != NULL)
+    {
+        *fresh = is_fresh;
+    }
+    return data;
+}
+
+void rtc_store_commit_slot(rtc_store_slot slot)
+{
+    if (slot >= RTC_STORE_SLOT_COUNT)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL(&store_lock);
+    seal_slot(slot);
+    taskEXIT_CRITICAL(&store_lock);
+}
+
+void rtc_store_commit(void)
+{
+    for (uint8_t slot = 0; slot < RTC_STORE_SLOT_COUNT; slot++)
+    {
+        rtc_store_commit_slot((rtc_store_slot)slot);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef RTC_STORE_H
+#define RTC_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * RTC State Store
+ *
+ * Typed, versioned and CRC-protected state that survives deep sleep (and
+ * software / watchdog / panic resets). Modules claim a fixed slot for one
+ * struct; a slot whose version, size or CRC does not match comes back zeroed
+ * and flagged fresh, so a layout change, a corrupted slot or a cold boot falls
+ * back to defaults instead of feeding garbage into the next wake.
+ *
+ * The whole store is discarded on power-on and brownout resets.
+ *
+ * Slot contents may be changed freely after claiming; rtc_store_commit()
+ * seals them (BoardLifecycle commits after wakeup and before deep sleep).
+ * A slot changed since its last commit fails its CRC after a crash and comes
+ * back fresh, so modules commit their slot with rtc_store_commit_slot() right
+ * after changes that must survive a crash later in the wake.
+ *
+ * Claims and commits may come from concurrent stage tasks; they are
+ * serialized internally. Writes to a slot's contents are the owner's business.
+ */
+
+// Bump when slot assignments or capacities change (discards every slot)
+#define RTC_STORE_SCHEMA_VERSION 1
+
+/**
+ * Fixed slot assignments. Append only; reordering needs a schema bump.
+ */
+typedef enum
+{
+    RTC_SLOT_LIFECYCLE = 0,   // BoardLifecycle wake history, overruns, latency histograms
+    RTC_SLOT_ENERGY,          // EnergyModel last wake report and totals
+    RTC_SLOT_SLEEP_SCHEDULER, // SleepScheduler moisture history
+    RTC_SLOT_APP,             // Application (main.cpp) cross-wake state
+    RTC_SLOT_POWER_MGMT,      // PowerMgmt pre-sleep GPIO audit
+    RTC_SLOT_READINESS,       // Readiness time-to-ready per signal
+    RTC_SLOT_BOOT_GUARD,      // BootGuard crash streak and backoff (committed at boot)
+    RTC_SLOT_TIME_KEEPER,     // TimeKeeper reference time, RTC drift and boot latency
+    RTC_SLOT_WIFI,            // WiFiConn fast-reconnect cache (BSSID, channel, PMK, IP lease, RSSI history)
+    RTC_STORE_SLOT_COUNT
+} rtc_store_slot;
+
+// Capacity of each slot in bytes (multiple of 4)
+static constexpr uint16_t rtc_store_slot_capacity[RTC_STORE_SLOT_COUNT] = {
+    512, // RTC_SLOT_LIFECYCLE
+    160, // RTC_SLOT_ENERGY
+    64,  // RTC_SLOT_SLEEP_SCHEDULER
+    96,  // RTC_SLOT_APP
+    32,  // RTC_SLOT_POWER_MGMT
+    48,  // RTC_SLOT_READINESS
+    32,  // RTC_SLOT_BOOT_GUARD
+    48,  // RTC_SLOT_TIME_KEEPER
+    96,  // RTC_SLOT_WIFI
+};
+
+/**
+ * Claim a slot (untyped; prefer the template below).
+ *
+ * @param slot Slot to claim
+ * @param version Layout version of the caller's struct (bump on layout change)
+ * @param size Size of the caller's struct (<= slot capacity)
+ * @param fresh Set to true if the slot was reset to zeros (may be NULL)
+ * @return Pointer to the slot's data, NULL if size exceeds the capacity
+ */
+void *rtc_store_claim(rtc_store_slot slot, uint16_t version, uint16_t size, bool *fresh);
+
+/**
+ * Claim a slot for struct T; the capacity is checked at compile time.
+ *
+ * @tparam T Struct kept in the slot (trivially copyable, zero is a valid default)
+ * @tparam Slot Slot to claim
+ */
+template <typename T, rtc_store_slot Slot>
+inline T *rtc_store_claim(uint16_t version, bool *fresh = NULL)
+{
+    static_assert(sizeof(T) <= rtc_store_slot_capacity[Slot], "State does not fit its RTC store slot");
+    return (T *)rtc_store_claim(Slot, version, (uint16_t)sizeof(T), fresh);
+}
+
+/**
+ * Seal one claimed slot (recompute its CRC).
+ */
+void rtc_store_commit_slot(rtc_store_slot slot);
+
+/**
+ * Seal all slots claimed during this wake.
+ */
+void rtc_store_commit(void);
+
+#endif // RTC_STORE_H
@@ -0,0 +1,176 @@
+#include "sleep_scheduler.h"
+#include <Arduino.h>
+#include <esp_rtc_time.h>
+#include <rtc_store.h>
+
+typedef struct
+{
+    uint32_t time_s; // RTC time of the reading (keeps counting through deep sleep)
+    int8_t moisture_percent;
+} moisture_sample;
+
+// Ring of recent readings, oldest at history_next once full (RTC store slot)
+typedef struct
+{
+    moisture_sample history[SLEEP_SCHEDULER_HISTORY_SIZE];
+    uint8_t history_count;
+    uint8_t history_next;
+} scheduler_rtc_state;
+
+#define SCHEDULER_RTC_STATE_VERSION 1
+
+static scheduler_rtc_state *rtc_state(void)
+{
+    static scheduler_rtc_state *rtc = NULL;
+    if (rtc == NULL)
+    {
+        rtc = rtc_store_claim<scheduler_rtc_state, RTC_SLOT_SLEEP_SCHEDULER>(SCHEDULER_RTC_STATE_VERSION);
+    }
+    return rtc;
+}
+
+// Readings closer together than this carry no useful rate
+#define SLEEP_SCHEDULER_MIN_RATE_WINDOW_S 600
+
+void sleep_scheduler_record_moisture(int moisture_percent)
+{
+    scheduler_rtc_state *rtc = rtc_state();
+    rtc->history[rtc->history_next].time_s = (uint32_t)(esp_rtc_get_time_us() / 1000000ULL);
+    rtc->history[rtc->history_next].moisture_percent = (int8_t)constrain(moisture_percent, 0, 100);
+
+    rtc->history_next = (rtc->history_next + 1) % SLEEP_SCHEDULER_HISTORY_SIZE;
+    if (rtc->history_count < SLEEP_SCHEDULER_HISTORY_SIZE)
+    {
+        rtc->history_count++;
+    }
+    rtc_store_commit_slot(RTC_SLOT_SLEEP_SCHEDULER);
+}
+
+float sleep_scheduler_moisture_rate(void)
+{
+    const scheduler_rtc_state *rtc = rtc_state();
+    if (rtc->history_count < 2)
+    {
+        return 0.0f;
+    }
+
+    uint8_t newest = (rtc->history_next + SLEEP_SCHEDULER_HISTORY_SIZE - 1) % SLEEP_SCHEDULER_HISTORY_SIZE;
+    uint8_t oldest = (rtc->history_next + SLEEP_SCHEDULER_HISTORY_SIZE - rtc->history_count) % SLEEP_SCHEDULER_HISTORY_SIZE;
+
+    uint32_t window_s = rtc->history[newest].time_s - rtc->history[oldest].time_s;
+    if (window_s < SLEEP_SCHEDULER_MIN_RATE_WINDOW_S)
+    {
+        return 0.0f;
+    }
+
+    float delta_pct = (float)(rtc->history[newest].moisture_percent - rtc->history[oldest].moisture_percent);
+    return delta_pct * 3600.0f / (float)window_s;
+}
+
+// How far (0..1) a weak battery stretches the interval towards max_sleep_s
+static float battery_stretch(const sleep_scheduler_policy *policy, const sleep_scheduler_battery *battery)
+{
+    if (battery->is_charging)
+    {
+        return 0.0f;
+    }
+
+    // Discharging fast enough to run flat soon
+    if (battery->change_rate < 0.0f &&
+        battery->state_of_charge / -battery->change_rate < policy->min_runtime_hours)
+    {
+        return 1.0f;
+    }
+
+    if (policy->good_soc_pct <= policy->low_soc_pct)
+    {
+        return 0.0f;
+    }
+
+    float stretch = (policy->good_soc_pct - battery->state_of_charge) / (policy->good_soc_pct - policy->low_soc_pct);
+    return constrain(stretch, 0.0f, 1.0f);
+}
+
+bool sleep_scheduler_surplus_power(const sleep_scheduler_policy *policy, const sleep_scheduler_battery *battery)
+{
+    if (policy->surplus_sleep_s == 0 || !battery->is_valid)
+    {
+        return false;
+    }
+    return battery->is_charging || (!battery->is_low_voltage && battery->state_of_charge >= policy->surplus_soc_pct);
+}
+
+uint64_t sleep_scheduler_next_sleep_seconds(const sleep_scheduler_policy *policy, const sleep_scheduler_battery *battery)
+{
+    if (!battery->is_valid || (battery->is_low_voltage && !battery->is_charging))
+    {
+        return policy->low_battery_sleep_s;
+    }
+
+    if (sleep_scheduler_surplus_power(policy, battery))
+    {
+        Serial.print(F("SleepScheduler: surplus power ("));
+        Serial.print(battery->is_charging ? F("charging") : F("charge in surplus band"));
+        Serial.print(F(") -> sleeping "));
+        Serial.print(policy->surplus_sleep_s);
+        Serial.println(F("s"));
+        return policy->surplus_sleep_s;
+    }
+
+    float rate = fabsf(sleep_scheduler_moisture_rate());
+    float interval = (float)policy->nominal_sleep_s;
+    if (policy->reference_rate_pct_per_hour > 0.0f)
+    {
+        interval /= 1.0f + rate / policy->reference_rate_pct_per_hour;
+    }
+
+    float stretch = battery_stretch(policy, battery);
+    interval += stretch * ((float)policy->max_sleep_s - interval);
+
+    interval = constrain(interval, (float)policy->min_sleep_s, (float)policy->max_sleep_s);
+
+    Serial.print(F("SleepScheduler: moisture rate "));
+    Serial.print(rate, 2);
+    Serial.print(F(" %/h, battery stretch "));
+    Serial.print(stretch, 2);
+    Serial.print(F(" -> sleeping "));
+    Serial.print((uint32_t)interval);
+    Serial.println(F("s"));
+
+    return (uint64_t)interval;
+}
+
+uint16_t sleep_scheduler_slot_from_id(const uint8_t *id, size_t length)
+{
+    // FNV-1a: neighbouring MACs (same vendor prefix, sequential serials) spread evenly
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= id[i];
+        hash *= 16777619UL;
+    }
+    return (uint16_t)(hash % SLEEP_SCHEDULER_SLOT_COUNT);
+}
+
+uint64_t sleep_scheduler_align_to_slot(uint64_t sleep_s, uint64_t now_s, uint16_t slot)
+{
+    const uint64_t period_s = SLEEP_SCHEDULER_SLOT_PERIOD_S;
+    if (sleep_s < period_s)
+    {
+        return sleep_s;
+    }
+
+    // Move the wake to the nearest occurrence of the slot's phase
+    uint64_t phase_s = (uint64_t)(slot % SLEEP_SCHEDULER_SLOT_COUNT) * SLEEP_SCHEDULER_SLOT_WIDTH_S;
+    uint64_t wake_s = now_s + sleep_s;
+    uint64_t offset_s = (wake_s + period_s - phase_s) % period_s;
+    uint64_t aligned_s = (offset_s > period_s / 2) ? sleep_s + (period_s - offset_s) : sleep_s - offset_s;
+
+    Serial.print(F("SleepScheduler: wake slot "));
+    Serial.print(slot);
+    Serial.print(F(" -> sleeping "));
+    Serial.print((uint32_t)aligned_s);
+    Serial.println(F("s"));
+
+    return aligned_s;
+}
@@ -0,0 +1,135 @@
+#ifndef SLEEP_SCHEDULER_H
+#define SLEEP_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Sleep Scheduler
+ *
+ * Picks the next deep sleep duration instead of a fixed cadence:
+ *  - soil activity shortens it: the nominal interval is divided by
+ *    (1 + |moisture rate| / reference rate), so soil drying after watering is
+ *    sampled often and stable soil at the nominal cadence;
+ *  - a weak battery stretches it towards the maximum (linearly between the
+ *    "good" and "low" state of charge, fully when the discharge rate projects
+ *    an empty battery too soon); charging removes the stretch;
+ *  - invalid / low-voltage battery readings sleep for the low battery interval;
+ *  - surplus power (charging, or state of charge in the top band) samples and
+ *    uploads at the short surplus interval, and drops back on its own once
+ *    charging stops and the charge leaves the band.
+ * Otherwise the result is clamped to [min_sleep_s, max_sleep_s].
+ *
+ * Moisture readings are kept in an RTC memory ring with RTC timestamps, so the
+ * rate of change is measured across wakes regardless of why the board woke.
+ *
+ * Fleet staggering: every device owns a wake slot (a stable phase within
+ * SLEEP_SCHEDULER_SLOT_PERIOD_S, hashed from its MAC or assigned by the broker)
+ * and long sleeps are shifted by up to half a period so the wake lands in it.
+ * Nodes that power up together (after an outage or a mass flash) then reach the
+ * AP, DHCP and the broker spread out instead of in lockstep.
+ */
+
+// Moisture readings kept across wakes for the rate of change
+#ifndef SLEEP_SCHEDULER_HISTORY_SIZE
+#define SLEEP_SCHEDULER_HISTORY_SIZE 4
+#endif
+
+// Period over which wake slots are spread; shorter sleeps are not aligned (seconds)
+#ifndef SLEEP_SCHEDULER_SLOT_PERIOD_S
+#define SLEEP_SCHEDULER_SLOT_PERIOD_S 900
+#endif
+
+// Width of one wake slot (seconds); the period holds PERIOD / WIDTH slots
+#ifndef SLEEP_SCHEDULER_SLOT_WIDTH_S
+#define SLEEP_SCHEDULER_SLOT_WIDTH_S 5
+#endif
+
+#define SLEEP_SCHEDULER_SLOT_COUNT (SLEEP_SCHEDULER_SLOT_PERIOD_S / SLEEP_SCHEDULER_SLOT_WIDTH_S)
+
+/**
+ * Scheduling policy (all durations in seconds).
+ */
+typedef struct
+{
+    uint32_t min_sleep_s;              // Shortest sleep (busiest soil)
+    uint32_t nominal_sleep_s;          // Stable soil, healthy battery
+    uint32_t max_sleep_s;              // Longest sleep (weak battery)
+    uint32_t low_battery_sleep_s;      // Invalid or low-voltage battery
+    float reference_rate_pct_per_hour; // Moisture rate that halves the nominal interval
+    float good_soc_pct;                // At or above: no battery stretch
+    float low_soc_pct;                 // At or below: full stretch to max_sleep_s
+    float min_runtime_hours;           // Projected runtime below which to stretch fully
+    uint32_t surplus_sleep_s;          // Charging or above surplus_soc_pct (0 disables surplus mode)
+    float surplus_soc_pct;             // At or above: surplus even when not charging
+} sleep_scheduler_policy;
+
+// Default policy: 30 min .. 7 h nominal .. 12 h, 10 h on low/invalid battery, 5 min while charging or >= 95 %
+#define SLEEP_SCHEDULER_DEFAULT_POLICY {30 * 60, 7 * 3600, 12 * 3600, 10 * 3600, 1.0f, 60.0f, 20.0f, 7 * 24.0f, 5 * 60, 95.0f}
+
+/**
+ * Battery state for one decision (from read_battery_status()).
+ */
+typedef struct
+{
+    bool is_valid;
+    bool is_charging;
+    bool is_low_voltage;
+    float state_of_charge; // %
+    float change_rate;     // %/hour, negative while discharging
+} sleep_scheduler_battery;
+
+/**
+ * Store this wake's moisture reading (RTC memory, timestamped).
+ *
+ * @param moisture_percent Moisture reading (0-100%)
+ */
+void sleep_scheduler_record_moisture(int moisture_percent);
+
+/**
+ * Moisture rate of change over the stored history.
+ *
+ * @return Rate in %/hour (signed, negative while drying), 0 with fewer than two readings
+ */
+float sleep_scheduler_moisture_rate(void);
+
+/**
+ * Check whether the battery has energy to spare (charging, or charged into the
+ * surplus band) for frequent sampling and uploads.
+ *
+ * @param policy Scheduling policy
+ * @param battery Current battery state
+ * @return true if surplus mode is enabled and the battery qualifies
+ */
+bool sleep_scheduler_surplus_power(const sleep_scheduler_policy *policy, const sleep_scheduler_battery *battery);
+
+/**
+ * Choose the next sleep duration.
+ *
+ * @param policy Scheduling policy
+ * @param battery Current battery state
+ * @return Sleep duration in seconds
+ */
+uint64_t sleep_scheduler_next_sleep_seconds(const sleep_scheduler_policy *policy, const sleep_scheduler_battery *battery);
+
+/**
+ * Derive a device's wake slot from a stable identifier (e.g. its MAC).
+ *
+ * @param id Identifier bytes
+ * @param length Number of bytes
+ * @return Slot in [0, SLEEP_SCHEDULER_SLOT_COUNT)
+ */
+uint16_t sleep_scheduler_slot_from_id(const uint8_t *id, size_t length);
+
+/**
+ * Shift a sleep so the wake lands in the device's slot. Sleeps shorter than
+ * the slot period (retries, follow-up wakes) are returned unchanged.
+ *
+ * @param sleep_s Sleep chosen by the policy
+ * @param now_s Current time on a clock shared by the fleet (wall clock, or time since power-on)
+ * @param slot Wake slot (out-of-range slots wrap)
+ * @return Aligned sleep in seconds, within half a period of sleep_s
+ */
+uint64_t sleep_scheduler_align_to_slot(uint64_t sleep_s, uint64_t now_s, uint16_t slot);
+
+#endif // SLEEP_SCHEDULER_H
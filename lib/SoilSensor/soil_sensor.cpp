@@ -1,6 +1,8 @@
 #include "soil_sensor.h"
 #include "../../include/soil_sensor_config.h"
 #include <HardwareSerial.h>
+#include <power_mgmt.h>
+#include <readiness.h>
 
 bool soil_sensor_start(void *context)
 {
@@ -12,8 +14,12 @@ bool soil_sensor_start(void *context)
     {
         pinMode(SOIL_SENSOR_VCC_PIN, OUTPUT);
         digitalWrite(SOIL_SENSOR_VCC_PIN, HIGH); // Power ON
-        delay(500);                              // Give time for sensor to power up
         Serial.println(F("Soil sensor powered ON"));
+
+        // Wait for the sensor output to settle instead of a fixed power-up delay
+        readiness_adc_probe probe;
+        readiness_adc_probe_init(&probe, SOIL_SENSOR_AOUT_PIN, SOIL_SENSOR_SETTLE_TOLERANCE);
+        readiness_wait(READINESS_SOIL_ADC, readiness_adc_settled, &probe, SOIL_SENSOR_READY_TIMEOUT_MS);
     }
     else
     {
@@ -129,7 +135,7 @@ int get_average_reading(int samples)
     for (int i = 0; i < samples; i++)
     {
         total += analogRead(SOIL_SENSOR_AOUT_PIN);
-        delay(50); // small delay between samples
+        power_mgmt_wait_ms(50); // small delay between samples
     }
     return (total) / samples;
 }
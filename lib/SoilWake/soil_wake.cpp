@@ -0,0 +1,104 @@
+#include "soil_wake.h"
+
+// True if a and b lie on different sides of threshold
+static bool crossed(uint8_t a, uint8_t b, uint8_t threshold)
+{
+    return (a < threshold) != (b < threshold);
+}
+
+static void push_history(soil_wake_state *state, uint8_t sample_pct)
+{
+    if (state->history_count == SOIL_WAKE_HISTORY_SIZE)
+    {
+        // Drop the oldest sample
+        for (uint8_t i = 1; i < SOIL_WAKE_HISTORY_SIZE; i++)
+        {
+            state->history_pct[i - 1] = state->history_pct[i];
+        }
+        state->history_count--;
+    }
+    state->history_pct[state->history_count++] = sample_pct;
+}
+
+// Median of the newest samples (the upper middle one of an even count)
+static uint8_t filtered_pct(const soil_wake_state *state)
+{
+    uint8_t count = (state->history_count < SOIL_WAKE_FILTER_SAMPLES) ? state->history_count : SOIL_WAKE_FILTER_SAMPLES;
+    uint8_t window[SOIL_WAKE_HISTORY_SIZE];
+
+    // Insertion sort of the newest samples
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t value = state->history_pct[state->history_count - count + i];
+        uint8_t j = i;
+        while (j > 0 && window[j - 1] > value)
+        {
+            window[j] = window[j - 1];
+            j--;
+        }
+        window[j] = value;
+    }
+    return window[count / 2];
+}
+
+soil_wake_decision soil_wake_evaluate(const soil_wake_policy *policy, soil_wake_state *state, uint8_t sample_pct, uint32_t now_s)
+{
+    uint8_t previous_pct = state->last_filtered_pct;
+
+    push_history(state, sample_pct);
+    uint8_t current_pct = filtered_pct(state);
+    state->last_filtered_pct = current_pct;
+
+    if (!state->has_report)
+    {
+        return SOIL_WAKE_FIRST;
+    }
+
+    if (crossed(previous_pct, current_pct, policy->low_threshold_pct) ||
+        crossed(previous_pct, current_pct, policy->high_threshold_pct))
+    {
+        return SOIL_WAKE_THRESHOLD;
+    }
+
+    uint8_t delta = (current_pct > state->last_reported_pct) ? current_pct - state->last_reported_pct
+                                                             : state->last_reported_pct - current_pct;
+    if (policy->delta_band_pct > 0 && delta >= policy->delta_band_pct)
+    {
+        return SOIL_WAKE_DELTA;
+    }
+
+    // Unsigned subtraction copes with the clock wrapping
+    if (now_s - state->last_report_s >= policy->upload_interval_s)
+    {
+        return SOIL_WAKE_INTERVAL;
+    }
+
+    return SOIL_WAKE_SLEEP;
+}
+
+void soil_wake_mark_reported(soil_wake_state *state, uint8_t reported_pct, uint32_t now_s)
+{
+    state->has_report = true;
+    state->last_reported_pct = reported_pct;
+    state->last_filtered_pct = reported_pct;
+    state->last_report_s = now_s;
+    push_history(state, reported_pct);
+}
+
+const char *soil_wake_decision_name(soil_wake_decision decision)
+{
+    switch (decision)
+    {
+    case SOIL_WAKE_SLEEP:
+        return "sleep";
+    case SOIL_WAKE_FIRST:
+        return "first";
+    case SOIL_WAKE_THRESHOLD:
+        return "threshold";
+    case SOIL_WAKE_DELTA:
+        return "delta";
+    case SOIL_WAKE_INTERVAL:
+        return "interval";
+    }
+    return "unknown";
+}
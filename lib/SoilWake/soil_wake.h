@@ -0,0 +1,94 @@
+#ifndef SOIL_WAKE_H
+#define SOIL_WAKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Soil Wake Decision
+ *
+ * Decides, per soil sample taken during a short radio-less wake, whether the
+ * node should do a full reporting wake: when moisture crosses a threshold,
+ * drifts out of a delta band around the last reported value, or the upload
+ * interval expired. Everything else goes back to sleep after sampling.
+ *
+ * Decisions use the median of the last SOIL_WAKE_FILTER_SAMPLES samples, so a
+ * single ADC spike (a splash, a loose connector) does not cost a full wake.
+ *
+ * Plain C++ with no Arduino / ESP-IDF dependencies so it builds on the host;
+ * the state struct is meant to live in RTC memory.
+ */
+
+// Recent samples kept in the decision state
+#ifndef SOIL_WAKE_HISTORY_SIZE
+#define SOIL_WAKE_HISTORY_SIZE 8
+#endif
+
+// Samples the decision median is taken over (at most SOIL_WAKE_HISTORY_SIZE)
+#ifndef SOIL_WAKE_FILTER_SAMPLES
+#define SOIL_WAKE_FILTER_SAMPLES 3
+#endif
+
+/**
+ * Reporting policy.
+ */
+typedef struct
+{
+    uint8_t low_threshold_pct;  // Report when moisture crosses this (dry alarm)
+    uint8_t high_threshold_pct; // Report when moisture crosses this (watered)
+    uint8_t delta_band_pct;     // Report when moisture moved this far from the last report
+    uint32_t upload_interval_s; // Report at least this often
+} soil_wake_policy;
+
+/**
+ * Why a sample does (or does not) warrant a reporting wake.
+ */
+typedef enum
+{
+    SOIL_WAKE_SLEEP = 0, // Nothing changed, keep sampling
+    SOIL_WAKE_FIRST,     // Nothing reported yet
+    SOIL_WAKE_THRESHOLD, // Crossed low or high threshold since the previous sample
+    SOIL_WAKE_DELTA,     // Left the delta band around the last report
+    SOIL_WAKE_INTERVAL   // Upload interval expired
+} soil_wake_decision;
+
+/**
+ * Decision state carried across wakes.
+ */
+typedef struct
+{
+    bool has_report;                             // A report was made since power-on
+    uint8_t last_reported_pct;                   // Moisture at the last report
+    uint32_t last_report_s;                      // Time of the last report (caller's clock)
+    uint8_t last_filtered_pct;                   // Previous filtered value (threshold crossing)
+    uint8_t history_pct[SOIL_WAKE_HISTORY_SIZE]; // Recent samples, oldest first
+    uint8_t history_count;
+} soil_wake_state;
+
+/**
+ * Record a sample and decide whether to wake for a report.
+ *
+ * @param policy Reporting policy
+ * @param state Decision state (updated)
+ * @param sample_pct Moisture sample (0-100%)
+ * @param now_s Current time in seconds on a clock that runs through deep sleep
+ * @return SOIL_WAKE_SLEEP, or the reason to report
+ */
+soil_wake_decision soil_wake_evaluate(const soil_wake_policy *policy, soil_wake_state *state, uint8_t sample_pct, uint32_t now_s);
+
+/**
+ * Mark a report as made: re-centres the delta band on the reported value,
+ * which also joins the history.
+ *
+ * @param state Decision state (updated)
+ * @param reported_pct Moisture value that was reported
+ * @param now_s Current time in seconds (same clock as soil_wake_evaluate())
+ */
+void soil_wake_mark_reported(soil_wake_state *state, uint8_t reported_pct, uint32_t now_s);
+
+/**
+ * Short name of a decision, for logs and diagnostics.
+ */
+const char *soil_wake_decision_name(soil_wake_decision decision);
+
+#endif // SOIL_WAKE_H
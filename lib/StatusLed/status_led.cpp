@@ -1,5 +1,39 @@
 #include "status_led.h"
 #include <Arduino.h>
+#include <power_mgmt.h>
+
+// Accumulated LED on-time this wake (for energy accounting)
+static uint32_t led_on_time_ms = 0;
+static uint32_t led_on_since_ms = 0;
+static bool led_is_on = false;
+static bool led_enabled = true;
+
+// Write the RGB LED and track how long it is lit
+static void write_status_led(uint8_t red, uint8_t green, uint8_t blue)
+{
+    rgbLedWrite(STATUS_LED_PIN, red, green, blue);
+
+    bool on = (red | green | blue) != 0;
+    if (on && !led_is_on)
+    {
+        led_on_since_ms = millis();
+    }
+    else if (!on && led_is_on)
+    {
+        led_on_time_ms += millis() - led_on_since_ms;
+    }
+    led_is_on = on;
+}
+
+void status_led_set_enabled(bool enabled)
+{
+    led_enabled = enabled;
+}
+
+uint32_t status_led_on_time_ms(void)
+{
+    return led_on_time_ms + (led_is_on ? millis() - led_on_since_ms : 0);
+}
 
 void set_status_led(uint8_t status)
 {
@@ -73,6 +107,11 @@ void set_status_led(uint8_t status)
 
 void set_custom_status_led(uint8_t statusLedColor)
 {
+    if (!led_enabled)
+    {
+        return;
+    }
+
     Serial.print(F("Status LED pin is: "));
     Serial.print(STATUS_LED_PIN);
     Serial.print(F(", setting color code: "));
@@ -81,41 +120,41 @@ void set_custom_status_led(uint8_t statusLedColor)
     {
     case STATUS_LED_RED:
         // Set LED to RED
-        rgbLedWrite(STATUS_LED_PIN, RGB_BRIGHTNESS, 0, 0); // Red
+        write_status_led(RGB_BRIGHTNESS, 0, 0); // Red
         break;
     case STATUS_LED_YELLOW:
         // Set LED to YELLOW
-        rgbLedWrite(STATUS_LED_PIN, RGB_BRIGHTNESS, RGB_BRIGHTNESS / 2, 0); // Yellow
+        write_status_led(RGB_BRIGHTNESS, RGB_BRIGHTNESS / 2, 0); // Yellow
         break;
     case STATUS_LED_ORANGE:
         // Set LED to ORANGE
-        rgbLedWrite(STATUS_LED_PIN, RGB_BRIGHTNESS, RGB_BRIGHTNESS / 4, 0); // Orange
+        write_status_led(RGB_BRIGHTNESS, RGB_BRIGHTNESS / 4, 0); // Orange
         break;
     case STATUS_LED_GREEN:
         // Set LED to GREEN
-        rgbLedWrite(STATUS_LED_PIN, 0, RGB_BRIGHTNESS, 0); // Green
+        write_status_led(0, RGB_BRIGHTNESS, 0); // Green
         break;
     case STATUS_LED_BLUE:
         // Set LED to BLUE
-        rgbLedWrite(STATUS_LED_PIN, 0, 0, RGB_BRIGHTNESS); // Blue
+        write_status_led(0, 0, RGB_BRIGHTNESS); // Blue
         break;
     case STATUS_LED_PURPLE:
         // Set LED to PURPLE
-        rgbLedWrite(STATUS_LED_PIN, RGB_BRIGHTNESS - 12, 0, RGB_BRIGHTNESS); // Purple
+        write_status_led(RGB_BRIGHTNESS - 12, 0, RGB_BRIGHTNESS); // Purple
         break;
     case STATUS_LED_CYAN:
         // Set LED to CYAN
-        rgbLedWrite(STATUS_LED_PIN, 0, RGB_BRIGHTNESS, RGB_BRIGHTNESS); // Cyan
+        write_status_led(0, RGB_BRIGHTNESS, RGB_BRIGHTNESS); // Cyan
         break;
     case STATUS_LED_WHITE:
         // Set LED to WHITE
-        rgbLedWrite(STATUS_LED_PIN, RGB_BRIGHTNESS, RGB_BRIGHTNESS, RGB_BRIGHTNESS); // White
+        write_status_led(RGB_BRIGHTNESS, RGB_BRIGHTNESS, RGB_BRIGHTNESS); // White
         break;
     case STATUS_LED_OFF:
         [[fallthrough]];
     default:
         // Turn LED OFF
-        rgbLedWrite(STATUS_LED_PIN, 0, 0, 0); // Off / black
+        write_status_led(0, 0, 0); // Off / black
         break;
     }
 }
@@ -137,6 +176,11 @@ void pulse_fast_status_led(unsigned int pulseCount, uint8_t statusLedColor)
 
 void pulse_custom_status_led(unsigned int pulseCount, unsigned int pulseDurationMs, unsigned int pauseDurationMs, uint8_t statusLedColor)
 {
+    if (!led_enabled)
+    {
+        return;
+    }
+
     Serial.print(F("Pulsing status LED with: "));
     Serial.print(pulseCount);
     Serial.print(F(" pulses, "));
@@ -149,10 +193,10 @@ void pulse_custom_status_led(unsigned int pulseCount, unsigned int pulseDuration
     for (unsigned int i = 0; i < pulseCount; i++)
     {
         set_custom_status_led(statusLedColor);
-        delay(pulseDurationMs);
+        power_mgmt_wait_ms(pulseDurationMs);
         // Turn LED OFF
-        rgbLedWrite(STATUS_LED_PIN, 0, 0, 0); // Off / black
-        delay(pauseDurationMs);
+        write_status_led(0, 0, 0); // Off / black
+        power_mgmt_wait_ms(pauseDurationMs);
     }
 }
 
@@ -162,7 +206,7 @@ void shutdown_status_led(void *context)
     (void)context; // Suppress unused parameter warning
 
     // Turn off the RGB LED completely
-    rgbLedWrite(STATUS_LED_PIN, 0, 0, 0);
+    write_status_led(0, 0, 0);
 
     // Set the status LED pin to INPUT_PULLDOWN to prevent current leakage during deep sleep
     pinMode(STATUS_LED_PIN, INPUT_PULLDOWN);
@@ -33,6 +33,22 @@ void pulse_slow_status_led(unsigned int pulseCount, uint8_t statusLedColor);
 void pulse_fast_status_led(unsigned int pulseCount, uint8_t statusLedColor);
 void pulse_custom_status_led(unsigned int pulseCount, unsigned int pulseDurationMs, unsigned int pauseDurationMs, uint8_t statusLedColor);
 
+/**
+ * Enable or disable the status LED (enabled at boot).
+ * While disabled every set / pulse call returns at once, without lighting the
+ * LED or waiting out the pulse timing; shutdown_status_led() still runs.
+ *
+ * @param enabled false to keep the LED dark
+ */
+void status_led_set_enabled(bool enabled);
+
+/**
+ * Get how long the status LED has been lit since boot.
+ *
+ * @return LED on-time in milliseconds
+ */
+uint32_t status_led_on_time_ms(void);
+
 /**
  * Shut down status LED for deep sleep.
  * Turns off the LED and sets the pin to INPUT_PULLDOWN to prevent current leakage.
@@ -0,0 +1,197 @@
+#include "time_keeper.h"
+#include <Arduino.h>
+#include <esp_rtc_time.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+#include <power_mgmt.h>
+#include <rtc_store.h>
+
+typedef struct
+{
+    int64_t ref_epoch_us;    // Last reference time
+    int64_t ref_rtc_us;      // RTC time the reference was taken at
+    int64_t target_epoch_us; // Target of the pending timer wake (0: none)
+    float drift_ppm;
+    int32_t boot_latency_us;
+    int32_t last_landing_us;
+    uint16_t drift_samples;
+    bool synced;
+} clock_rtc_state;
+
+#define CLOCK_RTC_STATE_VERSION 1
+
+// Drift samples beyond this are a bad reference, not a slow clock
+#define TIME_KEEPER_MAX_DRIFT_PPM 20000.0f
+
+// Landing errors beyond this are not boot latency (missed target, wake stub, manual reset)
+#define TIME_KEEPER_MAX_LANDING_US 30000000LL
+
+// Bounds of the learnt boot latency
+#define TIME_KEEPER_MAX_BOOT_LATENCY_US 5000000L
+
+// Poll interval while waiting for SNTP (ms)
+#define TIME_KEEPER_SNTP_POLL_MS 50
+
+static clock_rtc_state *rtc_state(void)
+{
+    static clock_rtc_state *rtc = NULL;
+    if (rtc == NULL)
+    {
+        rtc = rtc_store_claim<clock_rtc_state, RTC_SLOT_TIME_KEEPER>(CLOCK_RTC_STATE_VERSION);
+    }
+    return rtc;
+}
+
+static int64_t system_time_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// Wall-clock time at a given RTC time (synced clocks only)
+static int64_t epoch_at_rtc_us(const clock_rtc_state *rtc, int64_t rtc_us)
+{
+    double rtc_elapsed_us = (double)(rtc_us - rtc->ref_rtc_us);
+    return rtc->ref_epoch_us + (int64_t)(rtc_elapsed_us / (1.0 + rtc->drift_ppm * 1e-6));
+}
+
+int64_t time_keeper_now_us(void)
+{
+    const clock_rtc_state *rtc = rtc_state();
+    if (!rtc->synced)
+    {
+        return system_time_us();
+    }
+    return epoch_at_rtc_us(rtc, esp_rtc_get_time_us());
+}
+
+void time_keeper_begin(bool timer_wake)
+{
+    clock_rtc_state *rtc = rtc_state();
+
+    if (timer_wake && rtc->target_epoch_us != 0)
+    {
+        int64_t landing_us = time_keeper_now_us() - rtc->target_epoch_us;
+        if (landing_us > -TIME_KEEPER_MAX_LANDING_US && landing_us < TIME_KEEPER_MAX_LANDING_US)
+        {
+            rtc->last_landing_us = (int32_t)landing_us;
+
+            // The timer fired boot_latency_us early; whatever is left over is the estimate's error
+            int32_t latency_us = rtc->boot_latency_us + (int32_t)(landing_us / 4);
+            rtc->boot_latency_us = constrain(latency_us, 0L, TIME_KEEPER_MAX_BOOT_LATENCY_US);
+
+            Serial.print(F("TimeKeeper: landed "));
+            Serial.print((int32_t)(landing_us / 1000));
+            Serial.print(F("ms from target, boot latency now "));
+            Serial.print(rtc->boot_latency_us / 1000);
+            Serial.println(F("ms"));
+        }
+    }
+    rtc->target_epoch_us = 0;
+    rtc_store_commit_slot(RTC_SLOT_TIME_KEEPER);
+}
+
+void time_keeper_sync(int64_t epoch_us)
+{
+    clock_rtc_state *rtc = rtc_state();
+    int64_t rtc_now_us = esp_rtc_get_time_us();
+
+    if (rtc->synced)
+    {
+        int64_t true_elapsed_us = epoch_us - rtc->ref_epoch_us;
+        int64_t rtc_elapsed_us = rtc_now_us - rtc->ref_rtc_us;
+
+        // Keep the older reference until the window is long enough to measure drift
+        if (true_elapsed_us >= 0 && true_elapsed_us < TIME_KEEPER_MIN_DRIFT_WINDOW_S * 1000000LL)
+        {
+            return;
+        }
+
+        float sample_ppm = (float)((double)(rtc_elapsed_us - true_elapsed_us) * 1e6 / (double)true_elapsed_us);
+        if (true_elapsed_us > 0 && fabsf(sample_ppm) < TIME_KEEPER_MAX_DRIFT_PPM)
+        {
+            rtc->drift_ppm = (rtc->drift_samples == 0) ? sample_ppm : rtc->drift_ppm + (sample_ppm - rtc->drift_ppm) / 4.0f;
+            if (rtc->drift_samples < UINT16_MAX)
+            {
+                rtc->drift_samples++;
+            }
+        }
+
+        Serial.print(F("TimeKeeper: clock was off by "));
+        Serial.print((int32_t)((time_keeper_now_us() - epoch_us) / 1000));
+        Serial.print(F("ms, RTC drift "));
+        Serial.print(rtc->drift_ppm, 1);
+        Serial.println(F(" ppm"));
+    }
+
+    rtc->ref_epoch_us = epoch_us;
+    rtc->ref_rtc_us = rtc_now_us;
+    rtc->synced = true;
+    rtc_store_commit_slot(RTC_SLOT_TIME_KEEPER);
+
+    // Keep time() in step for everything else
+    struct timeval tv = {.tv_sec = (time_t)(epoch_us / 1000000LL), .tv_usec = (suseconds_t)(epoch_us % 1000000LL)};
+    settimeofday(&tv, NULL);
+}
+
+bool time_keeper_sntp_sync(void *context)
+{
+    (void)context;
+
+    if (rtc_state()->synced && time_keeper_get_status().age_s < TIME_KEEPER_SYNC_INTERVAL_S)
+    {
+        return true;
+    }
+
+    sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+    configTime(0, 0, TIME_KEEPER_NTP_SERVER);
+
+    unsigned long start = millis();
+    while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED && millis() - start < TIME_KEEPER_SNTP_TIMEOUT_MS)
+    {
+        power_mgmt_wait_ms(TIME_KEEPER_SNTP_POLL_MS);
+    }
+    bool completed = (sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED);
+    esp_sntp_stop();
+
+    if (!completed)
+    {
+        Serial.println(F("TimeKeeper: WARNING - No SNTP reply"));
+        return rtc_state()->synced;
+    }
+
+    time_keeper_sync(system_time_us());
+    return true;
+}
+
+uint64_t time_keeper_wake_rtc_us(int64_t target_epoch_us)
+{
+    clock_rtc_state *rtc = rtc_state();
+    int64_t rtc_now_us = esp_rtc_get_time_us();
+    int64_t now_us = rtc->synced ? epoch_at_rtc_us(rtc, rtc_now_us) : system_time_us();
+
+    int64_t sleep_us = target_epoch_us - rtc->boot_latency_us - now_us;
+    if (sleep_us < 1000000LL)
+    {
+        sleep_us = 1000000LL;
+    }
+    rtc->target_epoch_us = now_us + sleep_us + rtc->boot_latency_us;
+
+    // The sleep timer counts RTC time: a fast RTC needs proportionally more of it
+    double rtc_sleep_us = (double)sleep_us * (1.0 + rtc->drift_ppm * 1e-6);
+    return (uint64_t)(rtc_now_us + (int64_t)rtc_sleep_us);
+}
+
+time_keeper_status time_keeper_get_status(void)
+{
+    const clock_rtc_state *rtc = rtc_state();
+    time_keeper_status status = {
+        .synced = rtc->synced,
+        .age_s = rtc->synced ? (uint32_t)((esp_rtc_get_time_us() - rtc->ref_rtc_us) / 1000000ULL) : 0,
+        .drift_ppm = rtc->drift_ppm,
+        .drift_samples = rtc->drift_samples,
+        .boot_latency_us = rtc->boot_latency_us,
+        .last_landing_us = rtc->last_landing_us};
+    return status;
+}
@@ -0,0 +1,106 @@
+#ifndef TIME_KEEPER_H
+#define TIME_KEEPER_H
+
+#include <stdint.h>
+
+/**
+ * Time Keeper
+ *
+ * Wall-clock time for a board that spends nearly all of it in deep sleep.
+ *
+ * The RTC timer keeps counting through deep sleep, but on the slow clock it
+ * runs off by a fraction of a percent, i.e. minutes per day. Each reference
+ * time (SNTP, or a timestamp from the broker) is paired with the RTC time it
+ * was taken at; two references far enough apart give the RTC drift, kept as
+ * a smoothed estimate in RTC memory. Between references the wall clock is the
+ * last reference plus the drift-corrected RTC time since.
+ *
+ * Sleeps are computed to land on an absolute target time: the target is
+ * mapped to the RTC time the sleep timer must expire at, drift-corrected and
+ * less the expected boot latency (sleep timer expiry to time_keeper_begin()).
+ * An RTC time rather than an interval, so the work between computing it and
+ * arming the timer does not move the wake. The latency is learnt from
+ * how far each timer wake actually landed from its target.
+ */
+
+// SNTP server used by time_keeper_sntp_sync()
+#ifndef TIME_KEEPER_NTP_SERVER
+#define TIME_KEEPER_NTP_SERVER "pool.ntp.org"
+#endif
+
+// A reference older than this is refreshed by time_keeper_sntp_sync() (seconds)
+#ifndef TIME_KEEPER_SYNC_INTERVAL_S
+#define TIME_KEEPER_SYNC_INTERVAL_S (24 * 3600)
+#endif
+
+// How long time_keeper_sntp_sync() waits for an SNTP reply (ms)
+#ifndef TIME_KEEPER_SNTP_TIMEOUT_MS
+#define TIME_KEEPER_SNTP_TIMEOUT_MS 3000
+#endif
+
+// References closer together than this do not update the drift (seconds)
+#ifndef TIME_KEEPER_MIN_DRIFT_WINDOW_S
+#define TIME_KEEPER_MIN_DRIFT_WINDOW_S 3600
+#endif
+
+/**
+ * Clock state, for logs and reporting.
+ */
+typedef struct
+{
+    bool synced;              // A reference time has been taken since power-on
+    uint32_t age_s;           // Time since the last reference (seconds)
+    float drift_ppm;          // RTC drift (positive: RTC runs fast), 0 until two references
+    uint16_t drift_samples;   // References that updated the drift
+    int32_t boot_latency_us;  // Expected sleep timer expiry to time_keeper_begin()
+    int32_t last_landing_us;  // How far the last timer wake landed from its target (positive: late)
+} time_keeper_status;
+
+/**
+ * Learn from this wake's landing time. Call once, early in setup(), at the
+ * point a scheduled wake should land on its target.
+ *
+ * @param timer_wake true if the sleep timer ended the last sleep
+ */
+void time_keeper_begin(bool timer_wake);
+
+/**
+ * Take a reference time (SNTP, broker timestamp) and update the drift estimate.
+ *
+ * @param epoch_us Current wall-clock time (microseconds since the Unix epoch)
+ */
+void time_keeper_sync(int64_t epoch_us);
+
+/**
+ * Refresh the reference time over SNTP if it is missing or older than
+ * TIME_KEEPER_SYNC_INTERVAL_S. Lifecycle wakeup callback (needs WiFi).
+ *
+ * @param context Unused (may be NULL)
+ * @return true if a reference time is available (fresh or still recent)
+ */
+bool time_keeper_sntp_sync(void *context);
+
+/**
+ * Get the current wall-clock time.
+ *
+ * @return Microseconds since the Unix epoch, drift-corrected; the system time
+ *         (time since power-on) before the first reference
+ */
+int64_t time_keeper_now_us(void);
+
+/**
+ * Get the RTC time the sleep timer must expire at to wake the board on a target
+ * time (for board_lifecycle_enter_sleep_until()). Remembers the target to learn
+ * the boot latency on the next wake, so take any pending reference time first.
+ *
+ * @param target_epoch_us Wall-clock time the wake should land on (time_keeper_now_us() scale)
+ * @return Sleep timer expiry on the esp_rtc_get_time_us() scale (at least 1 s from now)
+ */
+uint64_t time_keeper_wake_rtc_us(int64_t target_epoch_us);
+
+/**
+ * Get the clock state.
+ */
+time_keeper_status time_keeper_get_status(void);
+
+#endif // TIME_KEEPER_H
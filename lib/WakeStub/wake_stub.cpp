@@ -0,0 +1,102 @@
+#include "wake_stub.h"
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <esp_wake_stub.h>
+
+#define WAKE_STUB_MAGIC 0x5753544B // "WSTK"
+
+// Read and written by the stub: must live in RTC memory and stay plain data.
+// RTC_DATA_ATTR is zeroed on power-on, so a cold boot never finds a schedule.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t remaining_intervals; // Timer intervals left until the full boot (incl. the running one)
+    uint64_t interval_us;         // Length of every interval but the last
+    uint64_t last_interval_us;    // Length of the final interval
+    uint32_t stub_wakes;          // Stub wakes during the current sleep
+    uint32_t total_stub_wakes;    // Since power-on
+} wake_stub_schedule;
+
+RTC_DATA_ATTR static wake_stub_schedule schedule;
+
+static uint32_t last_stub_wakes = 0;
+
+// Runs from RTC memory right after the ROM on every deep sleep wake
+static void RTC_IRAM_ATTR wake_stub(void)
+{
+    if (schedule.magic == WAKE_STUB_MAGIC && schedule.remaining_intervals > 1)
+    {
+        schedule.remaining_intervals--;
+        schedule.stub_wakes++;
+        schedule.total_stub_wakes++;
+
+        esp_wake_stub_set_wakeup_time((schedule.remaining_intervals == 1) ? schedule.last_interval_us
+                                                                         : schedule.interval_us);
+        esp_wake_stub_sleep(&wake_stub); // Does not return
+    }
+
+    // A full cycle is due: continue into the normal boot
+    esp_default_wake_deep_sleep();
+}
+
+void wake_stub_begin(void)
+{
+    if (schedule.magic != WAKE_STUB_MAGIC)
+    {
+        schedule = {};
+        schedule.magic = WAKE_STUB_MAGIC;
+    }
+
+    // Whatever woke us (timer, reset), the previous schedule is over
+    last_stub_wakes = schedule.stub_wakes;
+    schedule.stub_wakes = 0;
+    schedule.remaining_intervals = 0;
+
+    esp_set_deep_sleep_wake_stub(&wake_stub);
+
+    if (last_stub_wakes > 0)
+    {
+        Serial.print(F("WakeStub: "));
+        Serial.print(last_stub_wakes);
+        Serial.println(F(" stub wake(s) during the last sleep"));
+    }
+}
+
+uint64_t wake_stub_arm(uint64_t sleep_us)
+{
+    schedule.remaining_intervals = 0;
+
+#if WAKE_STUB_CHECK_INTERVAL_S > 0
+    const uint64_t interval_us = (uint64_t)WAKE_STUB_CHECK_INTERVAL_S * 1000000ULL;
+
+    if (schedule.magic != WAKE_STUB_MAGIC || sleep_us <= interval_us)
+    {
+        return sleep_us;
+    }
+
+    uint32_t intervals = (uint32_t)((sleep_us + interval_us - 1) / interval_us);
+    schedule.interval_us = interval_us;
+    schedule.last_interval_us = sleep_us - (uint64_t)(intervals - 1) * interval_us;
+    schedule.remaining_intervals = intervals;
+    schedule.stub_wakes = 0;
+
+    Serial.print(F("WakeStub: Sleep split into "));
+    Serial.print(intervals);
+    Serial.println(F(" intervals"));
+
+    return interval_us;
+#else
+    return sleep_us;
+#endif
+}
+
+uint32_t wake_stub_get_last_stub_wakes(void)
+{
+    return last_stub_wakes;
+}
+
+uint32_t wake_stub_get_total_stub_wakes(void)
+{
+    return schedule.total_stub_wakes;
+}
@@ -0,0 +1,51 @@
+#ifndef WAKE_STUB_H
+#define WAKE_STUB_H
+
+#include <stdint.h>
+
+/**
+ * Deep Sleep Wake Stub
+ *
+ * A long sleep can be split into shorter timer intervals. Each intermediate
+ * wake is handled by a stub in RTC memory that runs straight out of the ROM,
+ * before the bootloader, Arduino init and setup(): it checks the schedule kept
+ * in RTC memory and goes back to deep sleep in well under a millisecond when
+ * no full cycle is due. Only the wake that ends the sleep boots fully.
+ *
+ * The stub only runs code and data from RTC memory (no flash, no drivers), so
+ * every check it makes has to be cheap: today it counts down the schedule;
+ * RTC-side conditions (e.g. a flag set by an LP/ULP reading) belong here too.
+ *
+ * Assumes the timer is the only wake source (as set by board_lifecycle_enter_sleep()).
+ */
+
+// Stub wake interval (seconds) for long sleeps, 0 disables stub wakes
+#ifndef WAKE_STUB_CHECK_INTERVAL_S
+#define WAKE_STUB_CHECK_INTERVAL_S 0
+#endif
+
+/**
+ * Install the wake stub and collect the stub wakes of the last sleep.
+ * Call once per boot, early in setup().
+ */
+void wake_stub_begin(void);
+
+/**
+ * Arm the schedule for the coming deep sleep.
+ *
+ * @param sleep_us Time until the next full boot
+ * @return Timer interval to program for the first wake (== sleep_us without stub wakes)
+ */
+uint64_t wake_stub_arm(uint64_t sleep_us);
+
+/**
+ * Get the number of stub wakes (no full boot) during the last sleep.
+ */
+uint32_t wake_stub_get_last_stub_wakes(void);
+
+/**
+ * Get the number of stub wakes since power-on.
+ */
+uint32_t wake_stub_get_total_stub_wakes(void);
+
+#endif // WAKE_STUB_H
@@ -1,13 +1,31 @@
 #include "wifi_conn.h"
 #include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
 #include <HardwareSerial.h>
 #include <status_led.h>
 #include <status.h>
+#include <power_mgmt.h>
+#include <board_lifecycle.h>
+#include <rtc_store.h>
+#include <esp_rtc_time.h>
+#include <Preferences.h>
+#include <mbedtls/pkcs5.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 
 // Configuration constants
-#define WIFI_MAX_ATTEMPTS 50
-#define WIFI_BASE_DELAY_MS 100
-#define WIFI_RECONNECT_INTERVAL 5
+#define WIFI_RETRY_BASE_MS 250
+#define WIFI_RETRY_MAX_MS 2000
+#define WIFI_AUTH_FAILURE_LIMIT 2 // A single handshake timeout can be RF, two are a wrong password
+#define WIFI_NO_AP_LIMIT 2        // One full rescan before giving up on a missing SSID
+#define WIFI_RSSI_HISTORY 8       // Wakes of RSSI kept per AP
+#define WIFI_RADIO_BOOST_HOLD 8   // Clean connects before a retry boost is taken back
+#define WIFI_PMK_LENGTH 32
+#define WIFI_PBKDF2_ITERATIONS 4096
+#define WIFI_CACHE_NVS_NAMESPACE "wifi_cache"
 
 // Module-local state
 static char stored_ssid[64] = "";
@@ -15,6 +33,522 @@ static char stored_password[64] = "";
 static wifi_connection_status current_status;
 static bool credentials_set = false;
 
+// ===== Connection State Machine =====
+// Driven by WiFi events: GOT_IP ends the wait at once, a disconnect carries its reason
+
+#define WIFI_EVENT_GOT_IP_BIT (1 << 0)
+#define WIFI_EVENT_DISCONNECTED_BIT (1 << 1)
+
+static EventGroupHandle_t wifi_events = NULL;
+static volatile uint8_t last_disconnect_reason = 0;
+static volatile unsigned long associated_ms = 0;
+
+static void on_wifi_event(arduino_event_id_t event, arduino_event_info_t info)
+{
+    switch (event)
+    {
+    case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+        associated_ms = millis();
+        break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        xEventGroupSetBits(wifi_events, WIFI_EVENT_GOT_IP_BIT);
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        last_disconnect_reason = info.wifi_sta_disconnected.reason;
+        xEventGroupSetBits(wifi_events, WIFI_EVENT_DISCONNECTED_BIT);
+        break;
+    default:
+        break;
+    }
+}
+
+static bool init_wifi_events(void)
+{
+    if (wifi_events == NULL)
+    {
+        wifi_events = xEventGroupCreate();
+        if (wifi_events == NULL)
+        {
+            Serial.println(F("WiFi: Could not create event group"));
+            return false;
+        }
+        WiFi.onEvent(on_wifi_event);
+    }
+    return true;
+}
+
+static wifi_conn_failure classify_disconnect(uint8_t reason)
+{
+    switch (reason)
+    {
+    case WIFI_REASON_AUTH_FAIL:
+    case WIFI_REASON_MIC_FAILURE:
+    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_HANDSHAKE_TIMEOUT:
+        return WIFI_CONN_FAIL_WRONG_PASSWORD; // How the driver reports a wrong PSK
+    case WIFI_REASON_NO_AP_FOUND:
+        return WIFI_CONN_FAIL_NO_AP;
+    case WIFI_REASON_AUTH_EXPIRE:
+        return WIFI_CONN_FAIL_AUTH_TIMEOUT;
+    case WIFI_REASON_ASSOC_LEAVE:
+        return WIFI_CONN_FAIL_NONE; // Our own disconnect before this attempt
+    default:
+        return WIFI_CONN_FAIL_OTHER;
+    }
+}
+
+const char *wifi_conn_failure_name(wifi_conn_failure failure)
+{
+    switch (failure)
+    {
+    case WIFI_CONN_FAIL_NONE:
+        return "none";
+    case WIFI_CONN_FAIL_WRONG_PASSWORD:
+        return "wrong_password";
+    case WIFI_CONN_FAIL_NO_AP:
+        return "no_ap";
+    case WIFI_CONN_FAIL_AUTH_TIMEOUT:
+        return "auth_timeout";
+    case WIFI_CONN_FAIL_DEADLINE:
+        return "deadline";
+    default:
+        return "other";
+    }
+}
+
+// Connect and wait for an IP; with retry, transient failures are retried with
+// exponential backoff until the deadline
+static wifi_conn_failure connect_until(const char *ssid, const char *passphrase, int32_t channel,
+                                       const uint8_t *bssid, uint32_t deadline_ms, bool retry)
+{
+    if (!init_wifi_events())
+    {
+        return WIFI_CONN_FAIL_OTHER;
+    }
+
+    WiFi.setAutoReconnect(false); // Retries are decided here, not by the driver
+    unsigned long start = millis();
+    uint32_t backoff_ms = WIFI_RETRY_BASE_MS;
+    uint8_t auth_failures = 0;
+    uint8_t no_ap_failures = 0;
+
+    associated_ms = 0;
+    xEventGroupClearBits(wifi_events, WIFI_EVENT_GOT_IP_BIT | WIFI_EVENT_DISCONNECTED_BIT);
+    WiFi.begin(ssid, passphrase, channel, bssid);
+    current_status.attempts_made++;
+
+    while (true)
+    {
+        uint32_t elapsed_ms = millis() - start;
+        if (elapsed_ms >= deadline_ms)
+        {
+            return WIFI_CONN_FAIL_DEADLINE;
+        }
+
+        EventBits_t bits = xEventGroupWaitBits(wifi_events, WIFI_EVENT_GOT_IP_BIT | WIFI_EVENT_DISCONNECTED_BIT,
+                                               pdTRUE, pdFALSE, pdMS_TO_TICKS(deadline_ms - elapsed_ms));
+        if (bits & WIFI_EVENT_GOT_IP_BIT)
+        {
+            Serial.print(F("WiFi: Associated after "));
+            Serial.print((associated_ms != 0) ? associated_ms - start : 0);
+            Serial.print(F("ms, IP after "));
+            Serial.print(millis() - start);
+            Serial.println(F("ms"));
+            return WIFI_CONN_FAIL_NONE;
+        }
+        if (!(bits & WIFI_EVENT_DISCONNECTED_BIT))
+        {
+            return WIFI_CONN_FAIL_DEADLINE;
+        }
+
+        uint8_t reason = last_disconnect_reason;
+        wifi_conn_failure failure = classify_disconnect(reason);
+        if (failure == WIFI_CONN_FAIL_NONE)
+        {
+            continue;
+        }
+        current_status.disconnect_reason = reason;
+
+        Serial.print(F("WiFi: Disconnected, reason "));
+        Serial.print(reason);
+        Serial.print(F(" ("));
+        Serial.print(wifi_conn_failure_name(failure));
+        Serial.println(F(")"));
+
+        if (!retry ||
+            (failure == WIFI_CONN_FAIL_WRONG_PASSWORD && ++auth_failures >= WIFI_AUTH_FAILURE_LIMIT) ||
+            (failure == WIFI_CONN_FAIL_NO_AP && ++no_ap_failures >= WIFI_NO_AP_LIMIT) ||
+            millis() - start + backoff_ms >= deadline_ms)
+        {
+            return failure;
+        }
+
+        power_mgmt_wait_ms(backoff_ms);
+        backoff_ms = (backoff_ms * 2 < WIFI_RETRY_MAX_MS) ? backoff_ms * 2 : WIFI_RETRY_MAX_MS;
+
+        associated_ms = 0;
+        xEventGroupClearBits(wifi_events, WIFI_EVENT_GOT_IP_BIT | WIFI_EVENT_DISCONNECTED_BIT);
+        WiFi.reconnect();
+        current_status.attempts_made++;
+    }
+}
+
+// ===== Fast Reconnect Cache =====
+
+typedef struct
+{
+    int8_t rssi[WIFI_RSSI_HISTORY]; // dBm, ring buffer
+    uint8_t rssi_next;
+    uint8_t rssi_count;
+    uint8_t boost;        // Profile steps added after connects that needed retries
+    uint8_t clean_streak; // First-attempt connects since the last boost change
+} wifi_link_history;
+
+typedef struct
+{
+    uint32_t credentials_hash; // SSID + password the entry belongs to
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool has_ap;
+    uint8_t pmk[WIFI_PMK_LENGTH];
+    bool has_pmk;
+    bool sae_only;      // AP offers WPA3-SAE only: join with the plain password, the PMK is useless
+    bool has_lease;     // RTC only: a lease restored from NVS has an unknown age
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint32_t lease_rtc_s; // RTC time the lease was obtained over DHCP
+    uint32_t lease_reuse_s; // How long the lease may be reused from lease_rtc_s
+    wifi_link_history link; // RTC only, reset when the AP changes
+} wifi_cache;
+
+#define WIFI_CACHE_VERSION 2
+
+static wifi_cache *cache = NULL;
+
+static uint32_t rtc_seconds(void)
+{
+    return (uint32_t)(esp_rtc_get_time_us() / 1000000ULL);
+}
+
+static uint32_t credentials_hash(const char *ssid, const char *password)
+{
+    // FNV-1a over "ssid\0password"
+    uint32_t hash = 2166136261UL;
+    for (const char *p = ssid;; p++)
+    {
+        hash = (hash ^ (uint8_t)*p) * 16777619UL;
+        if (*p == '\0')
+        {
+            break;
+        }
+    }
+    for (const char *p = password; *p != '\0'; p++)
+    {
+        hash = (hash ^ (uint8_t)*p) * 16777619UL;
+    }
+    return hash;
+}
+
+// Persist AP and PMK (not the lease) for cold boots; only written when they change
+static void save_cache_backup(void)
+{
+    wifi_cache backup = *cache;
+    backup.has_lease = false;
+    memset(&backup.link, 0, sizeof(backup.link));
+
+    Preferences prefs;
+    if (prefs.begin(WIFI_CACHE_NVS_NAMESPACE, false))
+    {
+        wifi_cache stored = {};
+        if (prefs.getBytes("cache", &stored, sizeof(stored)) != sizeof(stored) ||
+            memcmp(&stored, &backup, sizeof(backup)) != 0)
+        {
+            prefs.putBytes("cache", &backup, sizeof(backup));
+        }
+        prefs.end();
+    }
+}
+
+// Claim the RTC cache (restored from NVS after a cold boot) and check it belongs to these credentials
+static wifi_cache *load_cache(const char *ssid, const char *password)
+{
+    if (cache == NULL)
+    {
+        bool fresh = false;
+        cache = rtc_store_claim<wifi_cache, RTC_SLOT_WIFI>(WIFI_CACHE_VERSION, &fresh);
+        if (fresh)
+        {
+            Preferences prefs;
+            if (prefs.begin(WIFI_CACHE_NVS_NAMESPACE, true))
+            {
+                if (prefs.getBytes("cache", cache, sizeof(*cache)) != sizeof(*cache))
+                {
+                    memset(cache, 0, sizeof(*cache));
+                }
+                prefs.end();
+            }
+            cache->has_lease = false;
+        }
+    }
+
+    uint32_t hash = credentials_hash(ssid, password);
+    if (cache->credentials_hash != hash)
+    {
+        memset(cache, 0, sizeof(*cache));
+        cache->credentials_hash = hash;
+    }
+    return cache;
+}
+
+// Derive the WPA2 PMK once and connect with it as a 64-digit hex PSK, which
+// skips the supplicant's PBKDF2 (4096 SHA-1 rounds) on every later wake
+static bool pmk_passphrase(const char *ssid, const char *password, char *hex, size_t hex_size)
+{
+    size_t length = strlen(password);
+    if (length < 8 || length > 63 || hex_size < 2 * WIFI_PMK_LENGTH + 1)
+    {
+        return false; // Open network, or the password is a PSK already
+    }
+
+    if (!cache->has_pmk)
+    {
+        unsigned long start = millis();
+        if (mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA1, (const unsigned char *)password, length,
+                                          (const unsigned char *)ssid, strlen(ssid), WIFI_PBKDF2_ITERATIONS,
+                                          WIFI_PMK_LENGTH, cache->pmk) != 0)
+        {
+            return false;
+        }
+        cache->has_pmk = true;
+        save_cache_backup();
+
+        Serial.print(F("WiFi: Derived PMK in "));
+        Serial.print(millis() - start);
+        Serial.println(F("ms"));
+    }
+
+    for (uint8_t i = 0; i < WIFI_PMK_LENGTH; i++)
+    {
+        snprintf(hex + 2 * i, 3, "%02x", cache->pmk[i]);
+    }
+    return true;
+}
+
+// Join the cached AP directly (and reuse the lease while fresh); drops the stale parts on failure
+static bool fast_connect(const char *ssid, const char *passphrase, bool *used_lease)
+{
+    *used_lease = cache->has_lease && rtc_seconds() - cache->lease_rtc_s < cache->lease_reuse_s;
+    if (*used_lease)
+    {
+        WiFi.config(IPAddress(cache->ip), IPAddress(cache->gateway), IPAddress(cache->subnet), IPAddress(cache->dns));
+    }
+
+    Serial.print(F("WiFi: Fast connect on channel "));
+    Serial.print(cache->channel);
+    Serial.println(*used_lease ? F(" with cached lease") : F(" with DHCP"));
+
+    // One attempt: any disconnect means the cached AP or lease is no longer good
+    if (connect_until(ssid, passphrase, cache->channel, cache->bssid, WIFI_FAST_CONNECT_TIMEOUT_MS, false) ==
+        WIFI_CONN_FAIL_NONE)
+    {
+        return true;
+    }
+
+    // AP moved, changed channel or refused the lease: full connect over DHCP
+    Serial.println(F("WiFi: Fast connect failed, invalidating cache"));
+    wifi_conn_invalidate_cache();
+    WiFi.disconnect();
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    return false;
+}
+
+// Reuse window of the lease just obtained: half the granted lease time (T1,
+// when a DHCP client would renew), capped; the default if the time is unknown
+static uint32_t lease_reuse_s(void)
+{
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif *lwip_netif = (netif != NULL) ? (struct netif *)esp_netif_get_netif_impl(netif) : NULL;
+    struct dhcp *dhcp = (lwip_netif != NULL) ? netif_dhcp_data(lwip_netif) : NULL;
+
+    // Set once when the lease is bound, before the GOT_IP event this runs after
+    uint32_t granted_s = (dhcp != NULL) ? dhcp->offered_t0_lease : 0;
+    if (granted_s == 0)
+    {
+        return WIFI_CACHE_LEASE_DEFAULT_AGE_S;
+    }
+    return (granted_s / 2 < WIFI_CACHE_LEASE_MAX_AGE_S) ? granted_s / 2 : WIFI_CACHE_LEASE_MAX_AGE_S;
+}
+
+// Remember how this connection was made for the next wake
+static void store_connection(bool lease_from_dhcp)
+{
+    const uint8_t *bssid = WiFi.BSSID();
+    uint8_t channel = (uint8_t)WiFi.channel();
+    if (bssid != NULL &&
+        (!cache->has_ap || channel != cache->channel || memcmp(cache->bssid, bssid, sizeof(cache->bssid)) != 0))
+    {
+        if (memcmp(cache->bssid, bssid, sizeof(cache->bssid)) != 0)
+        {
+            memset(&cache->link, 0, sizeof(cache->link)); // Another AP, another link
+        }
+        memcpy(cache->bssid, bssid, sizeof(cache->bssid));
+        cache->channel = channel;
+        cache->has_ap = true;
+        save_cache_backup();
+    }
+
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK && cache->sae_only != (ap.authmode == WIFI_AUTH_WPA3_PSK))
+    {
+        cache->sae_only = (ap.authmode == WIFI_AUTH_WPA3_PSK);
+        save_cache_backup();
+    }
+
+    if (lease_from_dhcp)
+    {
+        cache->ip = (uint32_t)WiFi.localIP();
+        cache->gateway = (uint32_t)WiFi.gatewayIP();
+        cache->subnet = (uint32_t)WiFi.subnetMask();
+        cache->dns = (uint32_t)WiFi.dnsIP(0);
+        cache->lease_rtc_s = rtc_seconds();
+        cache->lease_reuse_s = lease_reuse_s();
+        cache->has_lease = true;
+    }
+}
+
+// ===== Radio Profiles =====
+
+typedef struct
+{
+    const char *name;
+    wifi_power_t tx_power;
+    float connect_ma; // Rough average current while connecting (RX dominated, TX bursts)
+} radio_profile_config;
+
+static const radio_profile_config radio_profiles[WIFI_RADIO_PROFILE_COUNT] = {
+    {"near", WIFI_POWER_8_5dBm, 70.0f},
+    {"normal", WIFI_POWER_15dBm, 85.0f},
+    {"far", WIFI_POWER_19_5dBm, 100.0f},
+};
+
+// Average RSSI of the cached AP; false without history
+static bool link_rssi_avg(int8_t *avg)
+{
+    const wifi_link_history *link = &cache->link;
+    if (link->rssi_count == 0)
+    {
+        return false;
+    }
+
+    int16_t sum = 0;
+    for (uint8_t i = 0; i < link->rssi_count; i++)
+    {
+        sum += link->rssi[i];
+    }
+    *avg = (int8_t)(sum / link->rssi_count);
+    return true;
+}
+
+// The AP's signal at the node stands in for the node's signal at the AP
+static wifi_radio_profile choose_radio_profile(void)
+{
+    int8_t avg = 0;
+    if (!cache->has_ap || !link_rssi_avg(&avg))
+    {
+        return WIFI_RADIO_FAR; // Unknown link: full power
+    }
+
+    uint8_t profile = (avg >= WIFI_RADIO_NEAR_RSSI)  ? WIFI_RADIO_NEAR
+                      : (avg >= WIFI_RADIO_FAR_RSSI) ? WIFI_RADIO_NORMAL
+                                                     : WIFI_RADIO_FAR;
+    profile += cache->link.boost;
+    return (profile < WIFI_RADIO_FAR) ? (wifi_radio_profile)profile : WIFI_RADIO_FAR;
+}
+
+// Needs the STA interface started (WiFi.mode) and must precede WiFi.begin()
+static void apply_radio_profile(wifi_radio_profile profile)
+{
+#if WIFI_RADIO_RESTRICT_PHY || WIFI_RADIO_LONG_RANGE
+    uint8_t protocols = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N;
+#if WIFI_RADIO_LONG_RANGE
+    if (profile == WIFI_RADIO_FAR)
+    {
+        protocols |= WIFI_PROTOCOL_LR;
+    }
+#endif
+    esp_wifi_set_protocol(WIFI_IF_STA, protocols);
+    esp_wifi_set_bandwidth(WIFI_IF_STA, WIFI_BW_HT20);
+#endif
+
+    WiFi.setTxPower(radio_profiles[profile].tx_power);
+    current_status.radio_profile = profile;
+    current_status.tx_power_dbm = radio_profiles[profile].tx_power / 4.0f; // Quarter-dBm steps
+
+    Serial.print(F("WiFi: Radio profile "));
+    Serial.print(radio_profiles[profile].name);
+    Serial.print(F(", TX power "));
+    Serial.print(current_status.tx_power_dbm, 1);
+    Serial.println(F(" dBm"));
+}
+
+// Add this wake to the AP's history: the RSSI, and whether the connect needed retries
+static void record_link(bool clean)
+{
+    wifi_link_history *link = &cache->link;
+    link->rssi[link->rssi_next] = current_status.rssi;
+    link->rssi_next = (link->rssi_next + 1) % WIFI_RSSI_HISTORY;
+    if (link->rssi_count < WIFI_RSSI_HISTORY)
+    {
+        link->rssi_count++;
+    }
+
+    if (!clean)
+    {
+        if (link->boost < WIFI_RADIO_FAR)
+        {
+            link->boost++;
+        }
+        link->clean_streak = 0;
+    }
+    else if (link->boost > 0 && ++link->clean_streak >= WIFI_RADIO_BOOST_HOLD)
+    {
+        link->boost--;
+        link->clean_streak = 0;
+    }
+}
+
+static void record_connect_cost(unsigned long start)
+{
+    current_status.connect_ms = millis() - start;
+    current_status.connect_uah =
+        current_status.connect_ms * radio_profiles[current_status.radio_profile].connect_ma / 3600.0f;
+}
+
+void wifi_conn_set_power_save(bool idle)
+{
+    if (current_status.is_connected)
+    {
+        WiFi.setSleep(idle ? WIFI_PS_MAX_MODEM : WIFI_PS_NONE);
+    }
+}
+
+const char *wifi_conn_radio_profile_name(wifi_radio_profile profile)
+{
+    return (profile < WIFI_RADIO_PROFILE_COUNT) ? radio_profiles[profile].name : "unknown";
+}
+
+void wifi_conn_invalidate_cache(void)
+{
+    if (cache != NULL)
+    {
+        cache->has_ap = false;
+        cache->has_lease = false;
+        rtc_store_commit_slot(RTC_SLOT_WIFI);
+    }
+}
+
 void wifi_conn_set_credentials(const char *ssid, const char *password)
 {
     if (!ssid || !password)
@@ -42,6 +576,19 @@ bool wifi_conn_start(void *context)
     current_status.is_connected = false;
     current_status.attempts_made = 0;
     current_status.ip_address[0] = '\0';
+    current_status.fast_reconnect = false;
+    current_status.failure = WIFI_CONN_FAIL_NONE;
+    current_status.disconnect_reason = 0;
+    current_status.rssi = 0;
+    current_status.rssi_avg = 0;
+    unsigned long start = millis();
+
+    // Never outlast the lifecycle stage: an abandoned connect would race wifi_conn_stop()
+    uint32_t deadline_ms = board_lifecycle_stage_remaining_ms();
+    if (deadline_ms > WIFI_CONNECT_DEADLINE_MS)
+    {
+        deadline_ms = WIFI_CONNECT_DEADLINE_MS;
+    }
 
     // Extract credentials from context if provided
     const char *ssid = stored_ssid;
@@ -75,41 +622,77 @@ bool wifi_conn_start(void *context)
     Serial.print(F("Connecting to WiFi SSID: "));
     Serial.println(ssid);
     set_status_led(STATUS_WIFI_CONNECTING);
-    WiFi.begin(ssid, password);
 
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < WIFI_MAX_ATTEMPTS)
-    {
-        Serial.print(F("."));
-        attempts++;
-        delay(WIFI_BASE_DELAY_MS * attempts); // incremental back-off
+    load_cache(ssid, password);
+    char pmk_hex[2 * WIFI_PMK_LENGTH + 1];
+    const char *passphrase =
+        (!cache->sae_only && pmk_passphrase(ssid, password, pmk_hex, sizeof(pmk_hex))) ? pmk_hex : password;
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(WIFI_PS_NONE); // Connect burst; idle waits switch to modem sleep
+    apply_radio_profile(choose_radio_profile());
 
-        // try reconnecting every 5 attempts
-        if (attempts % WIFI_RECONNECT_INTERVAL == 0)
+    bool used_lease = false;
+    wifi_conn_failure failure = WIFI_CONN_FAIL_NONE;
+    if (cache->has_ap && fast_connect(ssid, passphrase, &used_lease))
+    {
+        current_status.fast_reconnect = true;
+    }
+    else
+    {
+        if (current_status.radio_profile != WIFI_RADIO_FAR)
         {
-            WiFi.reconnect();
+            apply_radio_profile(WIFI_RADIO_FAR); // The reduced power may be why the fast connect failed
         }
-    }
 
-    current_status.attempts_made = attempts;
+        uint32_t elapsed_ms = millis() - start;
+        failure = (elapsed_ms < deadline_ms)
+                      ? connect_until(ssid, password, 0, NULL, deadline_ms - elapsed_ms, true)
+                      : WIFI_CONN_FAIL_DEADLINE;
+    }
 
     // if we failed to connect to wifi
-    if (WiFi.status() != WL_CONNECTED)
+    if (failure != WIFI_CONN_FAIL_NONE)
     {
-        Serial.println(F(""));
-        Serial.println(F("Failed to reconnect to WiFi, entering emergency sleep..."));
+        Serial.print(F("Failed to connect to WiFi ("));
+        Serial.print(wifi_conn_failure_name(failure));
+        Serial.println(F("), entering emergency sleep..."));
         set_status_led(STATUS_ERROR);
+        WiFi.disconnect();
+        record_connect_cost(start);
+        if (cache->link.boost < WIFI_RADIO_FAR)
+        {
+            cache->link.boost++;
+        }
+        cache->link.clean_streak = 0;
+        rtc_store_commit_slot(RTC_SLOT_WIFI);
 
         current_status.is_valid = true;
         current_status.is_connected = false;
+        current_status.failure = failure;
         return false;
     }
 
-    Serial.println(F(""));
+    store_connection(!used_lease);
+    record_connect_cost(start);
+    current_status.rssi = (int8_t)WiFi.RSSI();
+    record_link(current_status.attempts_made == 1);
+    rtc_store_commit_slot(RTC_SLOT_WIFI); // AP, lease and link history survive a crash later in the wake
+    link_rssi_avg(&current_status.rssi_avg);
+
     Serial.println(F("WiFi connected."));
     set_status_led(STATUS_WIFI_CONNECTED);
     Serial.print(F("IP address: "));
     Serial.println(WiFi.localIP());
+    Serial.print(F("WiFi: RSSI "));
+    Serial.print(current_status.rssi);
+    Serial.print(F(" dBm (avg "));
+    Serial.print(current_status.rssi_avg);
+    Serial.print(F("), connected in "));
+    Serial.print(current_status.connect_ms);
+    Serial.print(F("ms, ~"));
+    Serial.print(current_status.connect_uah, 1);
+    Serial.println(F(" uAh"));
 
     // Update status with connection details
     current_status.is_valid = true;
@@ -140,7 +723,7 @@ void wifi_conn_stop(void *context)
     // shut down wifi
     WiFi.disconnect(true);
     WiFi.mode(WIFI_OFF);
-    delay(100); // allow time for wifi to shutdown
+    power_mgmt_wait_ms(100); // allow time for wifi to shutdown
 
     // Update status
     current_status.is_valid = false;
@@ -2,13 +2,107 @@
 #define WIFI_CONN_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Fast reconnect: the BSSID and channel of the last successful connection, the
+ * PMK derived from the passphrase and the DHCP lease are cached in RTC memory
+ * (AP and PMK also in NVS, for cold boots). A wake with a cache joins the known
+ * AP directly, without a scan, key derivation or DHCP exchange, and falls back
+ * to a full connect if that fails. A failed fast connect drops the AP and the
+ * lease from the cache. A lease is reused for half the lease time the DHCP
+ * server granted (when a DHCP client would renew it), at most
+ * WIFI_CACHE_LEASE_MAX_AGE_S, and renewed over DHCP after that.
+ *
+ * The full connect always uses the plain password, and an AP that only offers
+ * WPA3-SAE is joined with it on fast connects too (SAE has no reusable PMK).
+ */
+
+/**
+ * Radio profiles: the RSSI of the cached AP is kept over the last few wakes and
+ * its average picks the TX power, so a node next to the AP does not transmit at
+ * full power and a distant one gets all of it. An unknown link starts at full
+ * power, a connect that needed retries steps one profile up for a while, and a
+ * failed fast connect falls back to full power for the full connect.
+ */
+
+// Average RSSI at or above which the near profile is used (dBm)
+#ifndef WIFI_RADIO_NEAR_RSSI
+#define WIFI_RADIO_NEAR_RSSI -55
+#endif
+
+// Average RSSI below which the far profile is used (dBm)
+#ifndef WIFI_RADIO_FAR_RSSI
+#define WIFI_RADIO_FAR_RSSI -70
+#endif
+
+// Restrict the PHY to 802.11b/g/n at 20 MHz (better sensitivity, no HT40/HE negotiation)
+#ifndef WIFI_RADIO_RESTRICT_PHY
+#define WIFI_RADIO_RESTRICT_PHY 1
+#endif
+
+// Also enable Espressif long-range mode in the far profile (needs an LR-capable AP)
+#ifndef WIFI_RADIO_LONG_RANGE
+#define WIFI_RADIO_LONG_RANGE 0
+#endif
+
+// Hard deadline for wifi_conn_start(), fast and full connect together (ms)
+#ifndef WIFI_CONNECT_DEADLINE_MS
+#define WIFI_CONNECT_DEADLINE_MS 15000
+#endif
+
+// How long a fast (cached) connect may take before falling back (ms)
+#ifndef WIFI_FAST_CONNECT_TIMEOUT_MS
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 1500
+#endif
+
+// Cached IP lease reused without DHCP for at most this long, whatever the server granted (seconds)
+#ifndef WIFI_CACHE_LEASE_MAX_AGE_S
+#define WIFI_CACHE_LEASE_MAX_AGE_S (30 * 60)
+#endif
+
+// Reuse window of a lease whose granted time is unknown (seconds)
+#ifndef WIFI_CACHE_LEASE_DEFAULT_AGE_S
+#define WIFI_CACHE_LEASE_DEFAULT_AGE_S (15 * 60)
+#endif
+
+/**
+ * Why a connection failed, classified from the driver's disconnect reason.
+ * Wrong password and missing AP are not retried past a confirming second attempt.
+ */
+typedef enum
+{
+    WIFI_CONN_FAIL_NONE = 0,       // Connected (or not attempted)
+    WIFI_CONN_FAIL_WRONG_PASSWORD, // Authentication / 4-way handshake failed
+    WIFI_CONN_FAIL_NO_AP,          // SSID not found
+    WIFI_CONN_FAIL_AUTH_TIMEOUT,   // AP did not answer authentication in time
+    WIFI_CONN_FAIL_DEADLINE,       // WIFI_CONNECT_DEADLINE_MS ran out
+    WIFI_CONN_FAIL_OTHER           // Any other disconnect reason
+} wifi_conn_failure;
+
+typedef enum
+{
+    WIFI_RADIO_NEAR = 0, // Strong link: low TX power
+    WIFI_RADIO_NORMAL,   // Medium TX power
+    WIFI_RADIO_FAR,      // Weak or unknown link: full TX power
+    WIFI_RADIO_PROFILE_COUNT
+} wifi_radio_profile;
 
 typedef struct wifi_connection_status
 {
     bool is_connected;
-    char ip_address[16]; // "xxx.xxx.xxx.xxx" format
+    char ip_address[16];              // "xxx.xxx.xxx.xxx" format
     int attempts_made;
     bool is_valid;
+    bool fast_reconnect;              // Connected from the cache (no scan; no DHCP if the lease was fresh)
+    wifi_conn_failure failure;        // Why the last connect failed
+    uint8_t disconnect_reason;        // Driver reason code of the last disconnect (WIFI_REASON_*), 0 if none
+    wifi_radio_profile radio_profile; // Profile the connection was made with
+    float tx_power_dbm;               // TX power of that profile
+    int8_t rssi;                      // RSSI right after connecting (dBm)
+    int8_t rssi_avg;                  // Average over the AP's RSSI history, this wake included (dBm)
+    uint32_t connect_ms;              // wifi_conn_start() to IP address
+    float connect_uah;                // Estimated charge of the connect at the profile's current
 } wifi_connection_status;
 
 /**
@@ -21,8 +115,10 @@ typedef struct {
 } board_wifi_config_t;
 
 /**
- * Start WiFi connection with exponential backoff.
- * Attempts to connect up to 50 times with increasing delays.
+ * Start WiFi connection and wait for an IP address.
+ * Event driven: returns the moment the IP arrives. Transient disconnects are
+ * retried with exponential backoff; a wrong password or a missing AP stops after
+ * a confirming second attempt; everything stops at WIFI_CONNECT_DEADLINE_MS.
  * Updates internal connection status.
  *
  * @param context Pointer to wifi_config_t with SSID and password.
@@ -47,6 +143,32 @@ wifi_connection_status wifi_conn_get_status();
  */
 void wifi_conn_stop(void *context);
 
+/**
+ * Switch modem sleep for idle waits on an open connection.
+ * Idle uses WIFI_PS_MAX_MODEM: the radio only wakes for beacons, the
+ * association is kept, traffic gets a few hundred ms of latency. Not idle
+ * turns power save off for connect and publish bursts.
+ *
+ * @param idle true before waiting for messages, false before sending
+ */
+void wifi_conn_set_power_save(bool idle);
+
+/**
+ * Short name of a radio profile for logs and reports ("near", ...).
+ */
+const char *wifi_conn_radio_profile_name(wifi_radio_profile profile);
+
+/**
+ * Short name of a connection failure for logs ("wrong_password", ...).
+ */
+const char *wifi_conn_failure_name(wifi_conn_failure failure);
+
+/**
+ * Drop the cached AP and IP lease, e.g. when the network was joined from the
+ * cache but the broker could not be reached (the PMK is kept).
+ */
+void wifi_conn_invalidate_cache(void);
+
 /**
  * Set WiFi credentials for connection (LEGACY - prefer passing via context to wifi_conn_start).
  * Must be called before wifi_conn_start() if not using context parameter.
@@ -13,6 +13,17 @@
 #include <soil_sensor.h>
 #include <power_mgmt.h>
 #include <board_lifecycle.h>
+#include <energy_model.h>
+#include <sleep_scheduler.h>
+#include <soil_wake.h>
+#include <esp_rtc_time.h>
+#include <esp_timer.h>
+#include <esp_mac.h>
+#include <rtc_store.h>
+#include <wake_stub.h>
+#include <boot_guard.h>
+#include <time_keeper.h>
+#include <readiness.h>
 
 // =====  Board Configuration Structure =====
 // Unified configuration for all subsystems
@@ -28,16 +39,24 @@ typedef struct
     // don't need runtime configuration yet - they use build flags
 } board_config;
 
+// Static so the lifecycle table can reference it at compile time
+static board_config config = {
+    .wifi = {
+        .ssid = ssid,
+        .password = password},
+    .mqtt = {.broker_ip = mqtt_server, .broker_port = mqtt_server_port, .username = mqtt_user, .password = mqtt_password}};
+
 // ===== Peripheral Power Functions =====
 // Replaces all the duplicate wrapper code from old main.cpp
 
-static void peripheral_power_on(void *context)
+static bool peripheral_power_on(void *context)
 {
     // Context parameter reserved for future use
     (void)context;
 
     pinMode(PERIPHERAL_POWER_PIN, OUTPUT);
     digitalWrite(PERIPHERAL_POWER_PIN, PERIPHERAL_POWER_ON_STATE);
+    energy_model_state_on(ENERGY_STATE_PERIPHERAL_RAIL);
 
 #if PERIPHERAL_POWER_INVERTED
     Serial.println(F("Peripheral power ON (inverted logic: LOW=ON)"));
@@ -45,7 +64,8 @@ static void peripheral_power_on(void *context)
     Serial.println(F("Peripheral power ON (normal logic: HIGH=ON)"));
 #endif
 
-    delay(500); // Give time for peripherals to power up
+    power_mgmt_wait_ms(PERIPHERAL_POWER_SETTLE_MS); // Rail switch only; devices are waited for by their readiness probes
+    return true;
 }
 
 static void peripheral_power_off(void *context)
@@ -55,6 +75,7 @@ static void peripheral_power_off(void *context)
 
     pinMode(PERIPHERAL_POWER_PIN, OUTPUT);
     digitalWrite(PERIPHERAL_POWER_PIN, PERIPHERAL_POWER_OFF_STATE);
+    energy_model_state_off(ENERGY_STATE_PERIPHERAL_RAIL);
 
 #if PERIPHERAL_POWER_INVERTED
     Serial.println(F("Peripheral power OFF (inverted logic: HIGH=OFF)"));
@@ -62,150 +83,546 @@ static void peripheral_power_off(void *context)
     Serial.println(F("Peripheral power OFF (normal logic: LOW=OFF)"));
 #endif
 
-    delay(500); // Give time for peripherals to power down
+    power_mgmt_wait_ms(PERIPHERAL_POWER_SETTLE_MS); // Give time for the rail to switch off
 }
 
+// ===== Wake Cycle Readings =====
+// Sampled by the wakeup callbacks so sensor work overlaps WiFi/MQTT bring-up,
+// published from loop()
+
+static battery_status battery_reading = {};
+static SoilSensorReading soil_reading = {};
+
 // ===== Lifecycle Callback Wrappers =====
-// Wrap bool-returning functions to match void lifecycle callback signature
+// Sensor stages also take this cycle's reading; their status reflects the reading
 
-static void wakeup_battery_monitor(void *context)
+static bool wakeup_battery_monitor(void *context)
 {
     if (!battery_monitor_start(context))
     {
         Serial.println(F("WARNING: Battery monitor failed to start"));
+        return false;
     }
+
+    // Read once the fuel gauge has settled
+    battery_reading = read_battery_status();
+    return battery_reading.is_valid;
+}
+
+static bool wakeup_wifi(void *context)
+{
+    energy_model_state_on(ENERGY_STATE_RADIO_RX);
+    return wifi_conn_start(context);
+}
+
+static void sleep_wifi(void *context)
+{
+    wifi_conn_stop(context);
+    energy_model_state_off(ENERGY_STATE_RADIO_RX);
 }
 
-static void wakeup_wifi(void *context)
+// Drain pending messages with the modem asleep between beacons
+static void sleep_mqtt(void *context)
 {
-    if (!wifi_conn_start(context))
+    wifi_conn_set_power_save(true);
+    pubsub_stop(context);
+}
+
+static bool wakeup_soil_sensor(void *context)
+{
+    if (!soil_sensor_start(context))
     {
-        Serial.println(F("WARNING: WiFi connection failed"));
+        Serial.println(F("WARNING: Soil sensor failed to start"));
     }
+
+    // Sample while the radio is still associating
+    analogSetAttenuation(ADC_11db);
+    soil_reading = read_soil_moisture();
+    return soil_reading.rawValue != 0;
 }
 
-static void wakeup_mqtt(void *context)
+// ===== Lifecycle Table =====
+// Wake order top to bottom, sleep order bottom to top. Dependencies may only
+// point upwards; capacity and ordering are checked at compile time. A stage
+// running past its deadline (ms) is cancelled and its dependents are skipped.
+// Stages that mostly wait on hardware (rail, I2C, ADC) ask for a low CPU clock;
+// radio and payload work keeps the default (the highest running request wins).
+
+#ifndef LIFECYCLE_WAIT_CPU_MHZ
+#define LIFECYCLE_WAIT_CPU_MHZ 40
+#endif
+
+enum lifecycle_stage_id : uint8_t
 {
-    if (!pubsub_connect(context))
+    STAGE_POWER_MGMT,       // Releases GPIO holds from previous sleep / isolates GPIOs (sleeps LAST)
+    STAGE_ENERGY,           // Sleep-only: closes the wake's energy accounting once all loads are off
+    STAGE_PERIPHERAL_POWER, // Powers sensors/battery gauge
+    STAGE_STATUS_LED,       // Sleep-only: LED off + pulldown
+    STAGE_BATTERY,          // Depends on peripheral power + I2C
+    STAGE_WIFI,             // Independent, overlaps the sensor chain; nothing gets reported without it
+    STAGE_MQTT,             // Depends on WiFi (skipped if WiFi gave up)
+    STAGE_SOIL,             // Depends on peripheral power
+    STAGE_TIME,             // Depends on WiFi: refreshes the reference time over SNTP when due
+    STAGE_COUNT
+};
+
+// ===== Energy Accounting =====
+// Loads each stage holds on while its wakeup callback runs (CPU is implied)
+
+#define LOAD(state) ENERGY_STATE_MASK(state)
+
+static constexpr uint8_t stage_energy_loads(uint8_t stage)
+{
+    switch (stage)
     {
-        Serial.println(F("WARNING: MQTT connection failed"));
+    case STAGE_PERIPHERAL_POWER:
+    case STAGE_BATTERY:
+    case STAGE_SOIL:
+        return LOAD(ENERGY_STATE_PERIPHERAL_RAIL);
+    case STAGE_WIFI:
+    case STAGE_MQTT:
+    case STAGE_TIME:
+        return LOAD(ENERGY_STATE_RADIO_RX);
+    default:
+        return 0;
     }
 }
 
-static void wakeup_soil_sensor(void *context)
+static void account_wake_energy(void *context)
 {
-    if (!soil_sensor_start(context))
+    (void)context;
+
+    for (uint8_t i = 0; i < STAGE_COUNT; i++)
     {
-        Serial.println(F("WARNING: Soil sensor failed to start"));
+        energy_model_record_stage(i, board_lifecycle_get_wakeup_time_ms(i), stage_energy_loads(i),
+                                  board_lifecycle_get_stage_cpu_mhz(i));
     }
+    energy_model_add_state_time(ENERGY_STATE_LED, status_led_on_time_ms());
+    energy_model_add_state_time(ENERGY_STATE_CPU_ACTIVE, board_lifecycle_get_wake_info().wake_to_app_us / 1000);
+    energy_model_finish_wake(board_lifecycle_get_sleep_seconds());
 }
 
-// ===== Lifecycle Registration Helper =====
-// Centralizes all callback registration with clear dependency ordering
+static constexpr board_lifecycle_stage lifecycle_stages[] = {
+    {"power_mgmt", power_mgmt_post_wakeup, power_mgmt_prep_sleep, &config,
+     BOARD_LIFECYCLE_NO_DEPS, BOARD_LIFECYCLE_STAGE_OPTIONAL, 1000, BOARD_LIFECYCLE_DEFAULT_CLOCK},
+    {"energy", NULL, account_wake_energy, NULL,
+     BOARD_LIFECYCLE_NO_DEPS, BOARD_LIFECYCLE_STAGE_OPTIONAL, BOARD_LIFECYCLE_NO_DEADLINE, BOARD_LIFECYCLE_DEFAULT_CLOCK},
+    {"periph_power", peripheral_power_on, peripheral_power_off, &config,
+     BOARD_LIFECYCLE_DEPENDS_ON(STAGE_POWER_MGMT), BOARD_LIFECYCLE_STAGE_OPTIONAL, 2000, LIFECYCLE_WAIT_CPU_MHZ},
+    {"status_led", NULL, shutdown_status_led, &config,
+     BOARD_LIFECYCLE_NO_DEPS, BOARD_LIFECYCLE_STAGE_OPTIONAL, BOARD_LIFECYCLE_NO_DEADLINE, BOARD_LIFECYCLE_DEFAULT_CLOCK},
+    {"battery", wakeup_battery_monitor, battery_monitor_stop, &config,
+     BOARD_LIFECYCLE_DEPENDS_ON(STAGE_PERIPHERAL_POWER), BOARD_LIFECYCLE_STAGE_OPTIONAL, 5000, LIFECYCLE_WAIT_CPU_MHZ},
+    {"wifi", wakeup_wifi, sleep_wifi, &config.wifi,
+     BOARD_LIFECYCLE_NO_DEPS, BOARD_LIFECYCLE_STAGE_CRITICAL, 20000, BOARD_LIFECYCLE_DEFAULT_CLOCK},
+    {"mqtt", pubsub_connect, sleep_mqtt, &config.mqtt,
+     BOARD_LIFECYCLE_DEPENDS_ON(STAGE_WIFI), BOARD_LIFECYCLE_STAGE_CRITICAL, 15000, BOARD_LIFECYCLE_DEFAULT_CLOCK},
+    {"soil", wakeup_soil_sensor, soil_sensor_stop, &config,
+     BOARD_LIFECYCLE_DEPENDS_ON(STAGE_PERIPHERAL_POWER), BOARD_LIFECYCLE_STAGE_OPTIONAL, 5000, LIFECYCLE_WAIT_CPU_MHZ},
+    {"time", time_keeper_sntp_sync, NULL, NULL,
+     BOARD_LIFECYCLE_DEPENDS_ON(STAGE_WIFI), BOARD_LIFECYCLE_STAGE_OPTIONAL, 5000, BOARD_LIFECYCLE_DEFAULT_CLOCK},
+};
+
+BOARD_LIFECYCLE_CHECK_TABLE(lifecycle_stages);
+static_assert(sizeof(lifecycle_stages) / sizeof(lifecycle_stages[0]) == STAGE_COUNT,
+              "Lifecycle table out of sync with lifecycle_stage_id");
+static_assert(STAGE_COUNT <= ENERGY_MODEL_MAX_STAGES, "Too many stages for per-stage energy accounting");
+
+// Applies the stages' clocks and keeps the energy model's CPU current in step
+static uint32_t set_stage_cpu_clock(uint32_t cpu_mhz)
+{
+    uint32_t applied_mhz = power_mgmt_set_cpu_mhz(cpu_mhz);
+    energy_model_set_cpu_mhz(applied_mhz);
+    return applied_mhz;
+}
+
+// ===== Wake Profiles =====
+// Which stages a wake runs, chosen from the wake cause / reset reason
+
+#define STAGE(id) BOARD_LIFECYCLE_DEPENDS_ON(id)
+
+enum lifecycle_profile_id : uint8_t
+{
+    PROFILE_FULL,        // Sample + publish (regular timer wake, cold boot)
+    PROFILE_SAMPLE_ONLY, // Sensors only, radio stays off
+    PROFILE_BATTERY,     // Battery gauge only: last wake found the cell low or unreadable
+    PROFILE_GUARD_BACKOFF,  // Crashed: leave the rail off and sleep the backoff, nothing else
+    PROFILE_GUARD_NO_GAUGE, // Crashed again: everything but the fuel gauge
+    PROFILE_GUARD_RADIO,    // Still crashing: report over the radio only, no peripherals
+};
+
+static constexpr board_lifecycle_profile lifecycle_profiles[] = {
+    {"full", BOARD_LIFECYCLE_ALL_STAGES(STAGE_COUNT)},
+    {"sample_only", STAGE(STAGE_POWER_MGMT) | STAGE(STAGE_ENERGY) | STAGE(STAGE_PERIPHERAL_POWER) | STAGE(STAGE_STATUS_LED) |
+                        STAGE(STAGE_BATTERY) | STAGE(STAGE_SOIL)},
+    {"battery_check", STAGE(STAGE_POWER_MGMT) | STAGE(STAGE_ENERGY) | STAGE(STAGE_PERIPHERAL_POWER) | STAGE(STAGE_STATUS_LED) |
+                          STAGE(STAGE_BATTERY)},
+    {"guard_backoff", STAGE(STAGE_POWER_MGMT) | STAGE(STAGE_ENERGY) | STAGE(STAGE_PERIPHERAL_POWER) | STAGE(STAGE_STATUS_LED)},
+    {"guard_no_gauge", BOARD_LIFECYCLE_ALL_STAGES(STAGE_COUNT) & ~STAGE(STAGE_BATTERY)},
+    {"guard_radio", STAGE(STAGE_POWER_MGMT) | STAGE(STAGE_ENERGY) | STAGE(STAGE_STATUS_LED) | STAGE(STAGE_WIFI) |
+                        STAGE(STAGE_MQTT)},
+};
+
+BOARD_LIFECYCLE_CHECK_PROFILES(lifecycle_stages, lifecycle_profiles);
+
+// ===== Boot Timing =====
+// Where a wake's time goes before loop() (microseconds)
 
-void register_all_lifecycle_callbacks(board_config *config)
+typedef struct
 {
-    Serial.println(F("Registering lifecycle callbacks..."));
+    uint32_t wake_to_app_us;  // Sleep timer expiry to app start: ROM + bootloader (0 unless a timer wake)
+    uint32_t app_to_setup_us; // App start to setup(): IDF + Arduino init
+    uint32_t serial_us;       // Serial init / wait / end
+    uint32_t lifecycle_us;    // Lifecycle wakeup (all stages)
+    uint32_t setup_us;        // setup() total
+} boot_timing;
+
+static boot_timing boot = {};
+
+static uint32_t boot_time_us(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+// ===== Cross-Wake Application State =====
+// Kept in the RTC store; reset to defaults on cold boot or layout change
 
-    // ===== WAKEUP CALLBACKS (FIFO: execute in registration order) =====
+typedef struct
+{
+    uint16_t wakes_since_latency_publish;
+    bool soil_wake_report_due; // Set by a sample wake whose reading warrants a report
+    uint32_t soil_wake_upload_interval_s;
+    soil_wake_state soil_wake;
+    uint32_t gpio_audit_published_digest; // Digest of the last published GPIO audit
+    bool has_last_battery;
+    battery_status last_battery; // Reading of the previous wake, checked before any radio work
+    boot_timing boot_max;        // Slowest boot figures since the last boot timing publish
+    bool has_broker_slot;        // Wake slot assigned via WAKE_SLOT_MQTT_TOPIC (else MAC-derived)
+    uint16_t broker_slot;
+} app_rtc_state;
 
-    // 1. Peripheral power - MUST BE FIRST (powers sensors/battery)
-    board_lifecycle_register_wakeup(peripheral_power_on, config);
+#define APP_RTC_STATE_VERSION 5
 
-    // 2. Power management - releases GPIO holds from previous sleep
-    board_lifecycle_register_wakeup(power_mgmt_post_wakeup, config);
+static app_rtc_state *app_state(void)
+{
+    static app_rtc_state *state = NULL;
+    if (state == NULL)
+    {
+        bool fresh = false;
+        state = rtc_store_claim<app_rtc_state, RTC_SLOT_APP>(APP_RTC_STATE_VERSION, &fresh);
+        if (fresh)
+        {
+            state->soil_wake_report_due = true;
+            state->soil_wake_upload_interval_s = 7 * 3600;
+        }
+    }
+    return state;
+}
 
-    // 3. Battery monitor - depends on peripheral power + I2C
-    board_lifecycle_register_wakeup(wakeup_battery_monitor, config);
+// Set when this wake only re-checks a low or unreadable battery
+static bool battery_check_wake = false;
 
-    // 4. WiFi connection - independent, but MQTT needs it
-    board_lifecycle_register_wakeup(wakeup_wifi, &config->wifi);
+// The previous wake found the cell low (or the gauge unreadable): a wake with
+// WiFi + MQTT would most likely end in another low-battery sleep
+static bool last_battery_needs_check(void)
+{
+    const app_rtc_state *state = app_state();
+    return state->has_last_battery &&
+           (!state->last_battery.is_valid ||
+            (state->last_battery.is_low_voltage && !state->last_battery.is_charging));
+}
 
-    // 5. MQTT connection - depends on WiFi
-    board_lifecycle_register_wakeup(wakeup_mqtt, &config->mqtt);
+// Degraded profiles after repeated crashes, one step further per crash
+// (the first step keeps every stage and only turns the LED off)
+static uint8_t select_guard_profile(void)
+{
+    switch (boot_guard_get_phase())
+    {
+    case BOOT_GUARD_BACKOFF:
+        return PROFILE_GUARD_BACKOFF;
+    case BOOT_GUARD_DEGRADED:
+        if (boot_guard_level() >= 3)
+        {
+            return PROFILE_GUARD_RADIO;
+        }
+        return (boot_guard_level() == 2) ? PROFILE_GUARD_NO_GAUGE : PROFILE_FULL;
+    default:
+        return PROFILE_FULL;
+    }
+}
 
-    // 6. Soil sensor - depends on peripheral power
-    board_lifecycle_register_wakeup(wakeup_soil_sensor, config);
+static uint8_t select_lifecycle_profile(const board_lifecycle_wake_info *info)
+{
+    // Crash recovery overrides everything else until the guard steps back to normal
+    if (boot_guard_get_phase() == BOOT_GUARD_BACKOFF || boot_guard_get_phase() == BOOT_GUARD_DEGRADED)
+    {
+        return select_guard_profile();
+    }
 
-    // ===== SLEEP CALLBACKS (LIFO: execute in reverse order) =====
-    // Register in reverse so LIFO execution matches dependency order
+    // A brownout is most likely caused by the radio's TX current on a weak cell:
+    // take a reading but don't bring the radio up again right away
+    if (info->reset_reason == ESP_RST_BROWNOUT)
+    {
+        return PROFILE_SAMPLE_ONLY;
+    }
 
-    board_lifecycle_register_sleep(power_mgmt_prep_sleep, config);    // Executes 6th (LAST)
-    board_lifecycle_register_sleep(peripheral_power_off, config);     // Executes 5th
-    board_lifecycle_register_sleep(battery_monitor_stop, config);     // Executes 4th
-    board_lifecycle_register_sleep(shutdown_status_led, config);      // Executes 3rd
-    board_lifecycle_register_sleep(soil_sensor_stop, config);         // Executes 2nd
-    board_lifecycle_register_sleep(pubsub_disconnect, &config->mqtt); // Executes 1st (FIRST - also shuts down WiFi)
+    if (last_battery_needs_check())
+    {
+        Serial.println(F("Last wake found the battery low or invalid, checking it before any radio work"));
+        battery_check_wake = true;
+        return PROFILE_BATTERY;
+    }
 
-    Serial.println(F("Lifecycle callbacks registered successfully"));
+    switch (info->wakeup_cause)
+    {
+    case ESP_SLEEP_WAKEUP_EXT0:
+    case ESP_SLEEP_WAKEUP_EXT1:
+    case ESP_SLEEP_WAKEUP_GPIO:
+    case ESP_SLEEP_WAKEUP_TOUCHPAD:
+    case ESP_SLEEP_WAKEUP_ULP:
+        // Sensor-triggered wakes only need a fresh sample
+        return PROFILE_SAMPLE_ONLY;
+    case ESP_SLEEP_WAKEUP_TIMER:
+#if SOIL_WAKE_SAMPLING
+        // Timer wakes between reports only sample
+        return app_state()->soil_wake_report_due ? PROFILE_FULL : PROFILE_SAMPLE_ONLY;
+#endif
+    default:
+        // Regular timer wakes, emergency-sleep retries and cold boots report
+        return PROFILE_FULL;
+    }
+}
+
+// ===== Fleet Wake Slot =====
+// Long sleeps end in this device's slot, so a fleet powered up together does not
+// hit the AP and the broker in lockstep (MAC-derived unless the broker assigns one)
+
+static uint16_t wake_slot(void)
+{
+    if (app_state()->has_broker_slot)
+    {
+        return app_state()->broker_slot;
+    }
+
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA); // Same MAC as the MQTT client ID
+    return sleep_scheduler_slot_from_id(mac, sizeof(mac));
+}
+
+// Retained slot assignment: a slot number, anything else (e.g. "mac") reverts to the MAC-derived slot
+static void on_wake_slot_message(const char *topic, const uint8_t *payload, unsigned int length)
+{
+    (void)topic;
+
+    char value[8] = {};
+    memcpy(value, payload, (length < sizeof(value) - 1) ? length : sizeof(value) - 1);
+    char *end = NULL;
+    long slot = strtol(value, &end, 10);
+    bool valid = length > 0 && length < sizeof(value) && end != value && *end == '\0' &&
+                 slot >= 0 && slot < SLEEP_SCHEDULER_SLOT_COUNT;
+
+    app_state()->has_broker_slot = valid;
+    app_state()->broker_slot = valid ? (uint16_t)slot : 0;
+
+    Serial.print(F("Wake slot "));
+    Serial.println(valid ? F("assigned by broker") : F("from MAC"));
+}
+
+static void subscribe_wake_slot(void)
+{
+    String topic = get_mqtt_topic(WAKE_SLOT_MQTT_TOPIC);
+    pubsub_subscribe(topic.c_str(), on_wake_slot_message);
+}
+
+// Wall-clock time this wake landed; the cadence counts from here, not from the end of the wake
+static int64_t wake_start_us = 0;
+
+// Broker timestamp (not retained): Unix time in seconds, fractions allowed
+static void on_time_message(const char *topic, const uint8_t *payload, unsigned int length)
+{
+    (void)topic;
+
+    char value[24] = {};
+    memcpy(value, payload, (length < sizeof(value) - 1) ? length : sizeof(value) - 1);
+    char *end = NULL;
+    double epoch_s = strtod(value, &end);
+    if (end != value && epoch_s > 1.6e9)
+    {
+        time_keeper_sync((int64_t)(epoch_s * 1e6));
+    }
+}
+
+static void subscribe_broker_time(void)
+{
+    pubsub_subscribe(TIME_MQTT_TOPIC, on_time_message);
+}
+
+// Sleep until the next wake is due in this device's wake slot, on the drift-corrected clock
+static void sleep_in_slot(uint64_t seconds)
+{
+    // A broker timestamp may still be queued: take it before the target is computed
+    wifi_conn_set_power_save(true);
+    pubsub_drain();
+
+    int64_t now_us = time_keeper_now_us();
+    int64_t anchor_us = wake_start_us;
+    if (anchor_us + (int64_t)seconds * 1000000LL <= now_us)
+    {
+        anchor_us = now_us; // The wake outlasted the interval
+    }
+
+    uint64_t aligned_s = sleep_scheduler_align_to_slot(seconds, (uint64_t)(anchor_us / 1000000LL), wake_slot());
+    // The lifecycle arms the timer for this RTC time after the sleep callbacks
+    board_lifecycle_enter_sleep_until(time_keeper_wake_rtc_us(anchor_us + (int64_t)aligned_s * 1000000LL));
 }
 
 // ===== Setup Function =====
 // Configure and start lifecycle
 
+// Keep the slowest figure of each boot phase until it gets published
+static void record_boot_timing(void)
+{
+    boot_timing *max = &app_state()->boot_max;
+    max->wake_to_app_us = (boot.wake_to_app_us > max->wake_to_app_us) ? boot.wake_to_app_us : max->wake_to_app_us;
+    max->app_to_setup_us = (boot.app_to_setup_us > max->app_to_setup_us) ? boot.app_to_setup_us : max->app_to_setup_us;
+    max->serial_us = (boot.serial_us > max->serial_us) ? boot.serial_us : max->serial_us;
+    max->lifecycle_us = (boot.lifecycle_us > max->lifecycle_us) ? boot.lifecycle_us : max->lifecycle_us;
+    max->setup_us = (boot.setup_us > max->setup_us) ? boot.setup_us : max->setup_us;
+
+    Serial.print(F("Boot timing (us): wake->app "));
+    Serial.print(boot.wake_to_app_us);
+    Serial.print(F(", app->setup "));
+    Serial.print(boot.app_to_setup_us);
+    Serial.print(F(", serial "));
+    Serial.print(boot.serial_us);
+    Serial.print(F(", lifecycle "));
+    Serial.print(boot.lifecycle_us);
+    Serial.print(F(", setup "));
+    Serial.println(boot.setup_us);
+}
+
 void setup()
 {
+    uint32_t setup_start_us = boot_time_us();
+    boot.app_to_setup_us = setup_start_us;
+
     // 1. Check if we are outputting to serial
     if (ENABLE_SERIAL_CONNECTION != 0)
     {
         Serial.begin(115200);
-        delay(500); // Give time for Serial to initialize
 
-        unsigned long startTime = millis();
-        while (millis() - startTime < 20000)
+        // After a deep sleep wake the console is either attached already or not at all
+        if (!FAST_BOOT || esp_reset_reason() != ESP_RST_DEEPSLEEP)
         {
-            if (Serial)
+            power_mgmt_wait_ms(500); // Give time for Serial to initialize
+
+            unsigned long startTime = millis();
+            while (millis() - startTime < 20000)
             {
-                Serial.println("Serial connection detected, proceeding...");
-                break;
+                if (Serial)
+                {
+                    Serial.println("Serial connection detected, proceeding...");
+                    break;
+                }
+                power_mgmt_wait_ms(100);
             }
-            delay(100);
         }
     }
     else
     {
         Serial.end();
     }
+    boot.serial_us = boot_time_us() - setup_start_us;
 
     Serial.println("Board setup started...");
 
-    // 2. Configure subsystems
-    board_config config = {
-        .wifi = {
-            .ssid = ssid,
-            .password = password},
-        .mqtt = {.broker_ip = mqtt_server, .broker_port = mqtt_server_port, .username = mqtt_user, .password = mqtt_password}};
+    // Before anything that could hang: count crashes and overrun wakes, decide on backoff / degraded wakes
+    uint8_t overrun_stage = BOARD_LIFECYCLE_NO_STAGE;
+    bool overran = board_lifecycle_last_wake_overran(&overrun_stage);
+    if (boot_guard_begin(overran, (overrun_stage == BOARD_LIFECYCLE_NO_STAGE) ? BOOT_GUARD_NO_STAGE : overrun_stage) ==
+        BOOT_GUARD_DEGRADED)
+    {
+        status_led_set_enabled(false);
+    }
+
+    // A scheduled wake should land here: learn the boot latency, then anchor the next interval
+    time_keeper_begin(esp_reset_reason() == ESP_RST_DEEPSLEEP && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER);
+    wake_start_us = time_keeper_now_us();
 
-    // 3. Register wakeup and sleep callback functions
-    register_all_lifecycle_callbacks(&config);
+    // 2. Install the lifecycle table and wake profiles (validated at compile time, no registration work)
+    board_lifecycle_init(lifecycle_stages);
+    board_lifecycle_set_profiles(lifecycle_profiles, select_lifecycle_profile);
+    board_lifecycle_set_clock_handler(set_stage_cpu_clock);
 
-    // 4. Call the lifecycle wakeup method - let it start the system up
+    // Long sleeps may be split into stub-checked intervals (WAKE_STUB_CHECK_INTERVAL_S)
+    wake_stub_begin();
+    board_lifecycle_set_sleep_timer_handler(wake_stub_arm);
+
+    // Hard cap on awake time: if anything hangs past it, the board is put to sleep for an hour
+    board_lifecycle_set_awake_budget(60000, 3600ULL);
+
+    // 3. Call the lifecycle wakeup method - let it start the system up
+    uint32_t lifecycle_start_us = boot_time_us();
     board_lifecycle_status wakeup_status = board_lifecycle_wakeup();
+    boot.lifecycle_us = boot_time_us() - lifecycle_start_us;
+    boot.wake_to_app_us = board_lifecycle_get_wake_info().wake_to_app_us;
+
+    if (boot_guard_get_phase() == BOOT_GUARD_BACKOFF)
+    {
+        Serial.println(F("Recovering from a crash, backing off before the next attempt"));
+        board_lifecycle_enter_sleep(boot_guard_backoff_s());
+    }
 
     if (wakeup_status == BOARD_LIFECYCLE_TOTAL_FAILURE)
     {
-        Serial.println(F("CRITICAL: Wakeup lifecycle failed completely"));
+        Serial.println(F("CRITICAL: A critical wakeup stage failed (WiFi/MQTT)"));
         board_lifecycle_print_metrics();
-        board_lifecycle_enter_sleep(1200ULL); // Emergency 20min sleep
+        if (board_lifecycle_get_wakeup_result(STAGE_WIFI) == BOARD_LIFECYCLE_RESULT_OK &&
+            wifi_conn_get_status().fast_reconnect)
+        {
+            // Joined from the cache but the broker stayed out of reach: the cached lease may be stale
+            wifi_conn_invalidate_cache();
+        }
+        sleep_in_slot(1200ULL); // Emergency 20min sleep
     }
     else if (wakeup_status == BOARD_LIFECYCLE_PARTIAL_FAILURE)
     {
-        Serial.println(F("WARNING: Some wakeup callbacks failed"));
+        Serial.println(F("WARNING: Some optional wakeup callbacks failed or were skipped"));
         board_lifecycle_print_metrics();
         // Continue anyway - some subsystems may still work
     }
 
-    // 5. Final ADC configuration
-    analogSetAttenuation(ADC_11db);
+    boot.setup_us = boot_time_us() - setup_start_us;
+    record_boot_timing();
 
     Serial.println(F("Setup complete!"));
 }
 
 // ===== Helper Function for Publishing =====
 
-void publish_with_status(const char *topic, const char *payload)
+bool publish_with_status(const char *topic, const char *payload)
 {
-    if (publish_pub_sub_message(topic, payload))
+    // Radio-less profiles only sample; a publish must never bring MQTT up on its own
+    if (!board_lifecycle_stage_active(STAGE_MQTT))
+    {
+        Serial.print("MQTT not part of this wake's profile, not publishing to topic: ");
+        Serial.println(topic);
+        return false;
+    }
+
+    // Out of awake budget: the lifecycle expects us to head for sleep
+    if (board_lifecycle_budget_remaining_ms() == 0)
+    {
+        Serial.print("Awake budget exceeded, not publishing to topic: ");
+        Serial.println(topic);
+        return false;
+    }
+
+    energy_model_state_on(ENERGY_STATE_RADIO_TX);
+    bool published = publish_pub_sub_message(topic, payload);
+    energy_model_state_off(ENERGY_STATE_RADIO_TX);
+
+    if (published)
     {
         Serial.print("Published to topic: ");
         Serial.print(topic);
@@ -215,32 +632,419 @@ void publish_with_status(const char *topic, const char *payload)
     else
     {
         set_status_led(PUBSUB_PUB_ERROR);
-        delay(100);
+        power_mgmt_wait_ms(100);
+    }
+    return published;
+}
+
+// Report crashes once a wake has connectivity again
+static void publish_boot_guard_incident(void)
+{
+    boot_guard_status guard = boot_guard_get_status();
+    if (guard.unreported_crashes == 0)
+    {
+        return;
+    }
+
+    // {"reason":"task_wdt","stage":"","streak":2,"unreported":2,"total":5,"backoff_s":600,"profile":"guard_no_gauge"}
+    // (reason "overrun" with the stage that overran for wakes cut short by a deadline or the budget)
+    const char *stage = (guard.last_overran && guard.overrun_stage < STAGE_COUNT) ? lifecycle_stages[guard.overrun_stage].name : "";
+    char guardJson[192];
+    snprintf(guardJson, sizeof(guardJson),
+             "{\"reason\":\"%s\",\"stage\":\"%s\",\"streak\":%u,\"unreported\":%lu,\"total\":%lu,\"backoff_s\":%lu,\"profile\":\"%s\"}",
+             guard.last_overran ? "overrun" : boot_guard_reason_name(guard.last_reason), stage, guard.crash_streak, (unsigned long)guard.unreported_crashes,
+             (unsigned long)guard.total_crashes, (unsigned long)guard.backoff_s, board_lifecycle_get_profile_name());
+
+    String topic = get_mqtt_topic(BOOT_GUARD_MQTT_TOPIC);
+    if (publish_with_status(topic.c_str(), guardJson))
+    {
+        boot_guard_mark_reported();
+    }
+}
+
+// Publish the energy estimate of the previous wake (this wake is only complete once asleep)
+static void publish_energy_diagnostics(void)
+{
+    energy_model_report report = energy_model_get_report();
+    energy_model_print_report();
+
+    if (report.wake_count == 0)
+    {
+        return; // First wake since power-on, nothing accounted yet
     }
+
+    char valueStr[16];
+    snprintf(valueStr, sizeof(valueStr), "%.1f", report.last_wake_uah);
+    String topic = get_mqtt_topic(ENERGY_WAKE_MQTT_TOPIC);
+    publish_with_status(topic.c_str(), valueStr);
+
+    snprintf(valueStr, sizeof(valueStr), "%.1f", report.last_sleep_uah);
+    topic = get_mqtt_topic(ENERGY_SLEEP_MQTT_TOPIC);
+    publish_with_status(topic.c_str(), valueStr);
+
+    snprintf(valueStr, sizeof(valueStr), "%.3f", report.total_mah);
+    topic = get_mqtt_topic(ENERGY_TOTAL_MQTT_TOPIC);
+    publish_with_status(topic.c_str(), valueStr);
+
+    // Per-stage breakdown as a flat JSON object: {"wifi":812.4,...}
+    char stagesJson[256];
+    size_t len = snprintf(stagesJson, sizeof(stagesJson), "{");
+    for (uint8_t i = 0; i < report.stage_count && i < STAGE_COUNT && len < sizeof(stagesJson); i++)
+    {
+        len += snprintf(stagesJson + len, sizeof(stagesJson) - len, "%s\"%s\":%.1f",
+                        (i > 0) ? "," : "", lifecycle_stages[i].name, report.last_stage_uah[i]);
+    }
+    if (len < sizeof(stagesJson) - 1)
+    {
+        strcat(stagesJson, "}");
+        topic = get_mqtt_topic(ENERGY_STAGES_MQTT_TOPIC);
+        publish_with_status(topic.c_str(), stagesJson);
+    }
+}
+
+// Publish the radio profile this wake connected with and what the connect cost
+static void publish_radio_diagnostics(void)
+{
+    wifi_connection_status wifi = wifi_conn_get_status();
+    if (!wifi.is_connected)
+    {
+        return;
+    }
+
+    // {"profile":"near","tx_dbm":8.5,"rssi":-48,"rssi_avg":-50,"connect_ms":412,"connect_uah":8.0,"attempts":1,"fast":true}
+    char radioJson[192];
+    snprintf(radioJson, sizeof(radioJson),
+             "{\"profile\":\"%s\",\"tx_dbm\":%.1f,\"rssi\":%d,\"rssi_avg\":%d,\"connect_ms\":%lu,"
+             "\"connect_uah\":%.1f,\"attempts\":%d,\"fast\":%s}",
+             wifi_conn_radio_profile_name(wifi.radio_profile), wifi.tx_power_dbm, wifi.rssi, wifi.rssi_avg,
+             (unsigned long)wifi.connect_ms, wifi.connect_uah, wifi.attempts_made, wifi.fast_reconnect ? "true" : "false");
+    String topic = get_mqtt_topic(RADIO_MQTT_TOPIC);
+    publish_with_status(topic.c_str(), radioJson);
+}
+
+// Publish the GPIO audit of the previous sleep when a pin was off or the pin states changed
+static void publish_gpio_audit_diagnostics(void)
+{
+    power_mgmt_gpio_audit audit;
+    if (!power_mgmt_get_gpio_audit(&audit) ||
+        (audit.mismatch_count == 0 && audit.digest == app_state()->gpio_audit_published_digest))
+    {
+        return;
+    }
+
+    // {"digest":"1a2b3c4d","mismatch":[4,23]}
+    char auditJson[192];
+    size_t len = snprintf(auditJson, sizeof(auditJson), "{\"digest\":\"%08lx\",\"mismatch\":[",
+                          (unsigned long)audit.digest);
+    bool first = true;
+    for (uint8_t pin = 0; pin < 64 && len < sizeof(auditJson); pin++)
+    {
+        if (audit.mismatch_mask & (1ULL << pin))
+        {
+            len += snprintf(auditJson + len, sizeof(auditJson) - len, "%s%u", first ? "" : ",", pin);
+            first = false;
+        }
+    }
+    if (len >= sizeof(auditJson) - 2)
+    {
+        Serial.println(F("WARNING: GPIO audit payload too large, not publishing"));
+        return;
+    }
+    strcat(auditJson, "]}");
+
+    String topic = get_mqtt_topic(GPIO_AUDIT_MQTT_TOPIC);
+    if (publish_with_status(topic.c_str(), auditJson))
+    {
+        app_state()->gpio_audit_published_digest = audit.digest;
+    }
+}
+
+// Publish per-stage latency histograms, boot timing and clock state every few wakes, then start a new window
+#ifndef LATENCY_PUBLISH_INTERVAL_WAKES
+#define LATENCY_PUBLISH_INTERVAL_WAKES 12
+#endif
+
+static void publish_latency_diagnostics(void)
+{
+    if (++app_state()->wakes_since_latency_publish < LATENCY_PUBLISH_INTERVAL_WAKES ||
+        !board_lifecycle_stage_active(STAGE_MQTT))
+    {
+        return;
+    }
+
+    // {"wifi":[p50,p95,max,samples],...}
+    char latencyJson[512];
+    size_t len = snprintf(latencyJson, sizeof(latencyJson), "{");
+    for (uint8_t i = 0; i < STAGE_COUNT && len < sizeof(latencyJson); i++)
+    {
+        board_lifecycle_latency latency;
+        if (!board_lifecycle_get_stage_latency(i, &latency) || latency.samples == 0)
+        {
+            continue;
+        }
+        len += snprintf(latencyJson + len, sizeof(latencyJson) - len, "%s\"%s\":[%lu,%lu,%lu,%lu]",
+                        (len > 1) ? "," : "", lifecycle_stages[i].name, (unsigned long)latency.p50_ms,
+                        (unsigned long)latency.p95_ms, (unsigned long)latency.max_ms, (unsigned long)latency.samples);
+    }
+    if (len >= sizeof(latencyJson) - 1)
+    {
+        Serial.println(F("WARNING: Latency payload too large, not publishing"));
+        return;
+    }
+    strcat(latencyJson, "}");
+
+    String topic = get_mqtt_topic(LIFECYCLE_LATENCY_MQTT_TOPIC);
+    if (publish_with_status(topic.c_str(), latencyJson))
+    {
+        board_lifecycle_reset_latency();
+        app_state()->wakes_since_latency_publish = 0;
+    }
+
+    // Boot phases of this wake and the slowest since the last publish: {"setup":[cur_us,max_us],...}
+    const boot_timing *max = &app_state()->boot_max;
+    char bootJson[192];
+    snprintf(bootJson, sizeof(bootJson),
+             "{\"wake_to_app\":[%lu,%lu],\"app_to_setup\":[%lu,%lu],\"serial\":[%lu,%lu],"
+             "\"lifecycle\":[%lu,%lu],\"setup\":[%lu,%lu]}",
+             (unsigned long)boot.wake_to_app_us, (unsigned long)max->wake_to_app_us,
+             (unsigned long)boot.app_to_setup_us, (unsigned long)max->app_to_setup_us,
+             (unsigned long)boot.serial_us, (unsigned long)max->serial_us,
+             (unsigned long)boot.lifecycle_us, (unsigned long)max->lifecycle_us,
+             (unsigned long)boot.setup_us, (unsigned long)max->setup_us);
+    topic = get_mqtt_topic(BOOT_TIMING_MQTT_TOPIC);
+    if (publish_with_status(topic.c_str(), bootJson))
+    {
+        app_state()->boot_max = boot_timing{};
+    }
+
+    // Peripheral time-to-ready since the last cold boot: {"soil_adc":[last_ms,max_ms,samples,timeouts],...}
+    char readinessJson[192];
+    len = snprintf(readinessJson, sizeof(readinessJson), "{");
+    for (uint8_t i = 0; i < READINESS_SIGNAL_COUNT && len < sizeof(readinessJson); i++)
+    {
+        readiness_stats stats;
+        if (!readiness_get_stats((readiness_signal)i, &stats) || (stats.samples == 0 && stats.timeouts == 0))
+        {
+            continue;
+        }
+        len += snprintf(readinessJson + len, sizeof(readinessJson) - len, "%s\"%s\":[%lu,%lu,%u,%u]",
+                        (len > 1) ? "," : "", readiness_signal_name((readiness_signal)i), (unsigned long)stats.last_ms,
+                        (unsigned long)stats.max_ms, stats.samples, stats.timeouts);
+    }
+    if (len < sizeof(readinessJson) - 1)
+    {
+        strcat(readinessJson, "}");
+        topic = get_mqtt_topic(READINESS_MQTT_TOPIC);
+        publish_with_status(topic.c_str(), readinessJson);
+    }
+
+    // {"synced":true,"age_s":3600,"drift_ppm":-412.5,"drift_samples":3,"boot_latency_ms":182,"landing_ms":-4}
+    time_keeper_status clock = time_keeper_get_status();
+    char clockJson[160];
+    snprintf(clockJson, sizeof(clockJson),
+             "{\"synced\":%s,\"age_s\":%lu,\"drift_ppm\":%.1f,\"drift_samples\":%u,\"boot_latency_ms\":%ld,\"landing_ms\":%ld}",
+             clock.synced ? "true" : "false", (unsigned long)clock.age_s, clock.drift_ppm, clock.drift_samples,
+             (long)(clock.boot_latency_us / 1000), (long)(clock.last_landing_us / 1000));
+    topic = get_mqtt_topic(CLOCK_MQTT_TOPIC);
+    publish_with_status(topic.c_str(), clockJson);
+}
+
+// ===== Sleep Scheduling =====
+
+static const sleep_scheduler_policy sleep_policy = SLEEP_SCHEDULER_DEFAULT_POLICY;
+
+static sleep_scheduler_battery scheduler_battery(const battery_status *status)
+{
+    sleep_scheduler_battery battery = {
+        .is_valid = status->is_valid,
+        .is_charging = status->is_charging,
+        .is_low_voltage = status->is_low_voltage,
+        .state_of_charge = status->state_of_charge,
+        .change_rate = status->change_rate};
+    return battery;
+}
+
+static uint64_t next_sleep_seconds(const battery_status *status)
+{
+    sleep_scheduler_battery battery = scheduler_battery(status);
+    return sleep_scheduler_next_sleep_seconds(&sleep_policy, &battery);
 }
 
+// ===== Charging Stream =====
+// On external power the wake does not end: it stays connected and publishes a
+// fresh reading every surplus interval until charging stops or the broker is lost
+
+#ifndef CHARGING_STREAM
+#define CHARGING_STREAM 1
+#endif
+
+// How often the MQTT connection is serviced between stream readings (ms)
+#ifndef CHARGING_STREAM_POLL_MS
+#define CHARGING_STREAM_POLL_MS 1000
+#endif
+
+// Awake budget for publishing one stream reading (ms)
+#ifndef CHARGING_STREAM_WORK_MS
+#define CHARGING_STREAM_WORK_MS 60000
+#endif
+
+// Set once this wake has started streaming
+static bool streaming = false;
+
+static bool charging_stream_due(const battery_status *status)
+{
+#if CHARGING_STREAM
+    return sleep_policy.surplus_sleep_s > 0 && status->is_valid && status->is_charging &&
+           board_lifecycle_stage_active(STAGE_BATTERY) && board_lifecycle_stage_active(STAGE_MQTT);
+#else
+    (void)status;
+    return false;
+#endif
+}
+
+// Stay awake and connected until the next stream reading; false once the broker is lost
+static bool charging_stream_wait(void)
+{
+    uint32_t interval_ms = sleep_policy.surplus_sleep_s * 1000UL;
+    board_lifecycle_renew_awake_budget(interval_ms + CHARGING_STREAM_WORK_MS);
+
+    // Streaming may run for hours without reaching sleep: seal what this reading changed
+    rtc_store_commit();
+
+    Serial.print(F("On external power, streaming: next reading in "));
+    Serial.print(sleep_policy.surplus_sleep_s);
+    Serial.println(F("s"));
+
+    wifi_conn_set_power_save(true);
+    uint32_t start_ms = millis();
+    while (millis() - start_ms < interval_ms)
+    {
+        if (!pubsub_service())
+        {
+            Serial.println(F("Stream: broker connection lost, going back to sleep"));
+            return false;
+        }
+        power_mgmt_wait_ms(CHARGING_STREAM_POLL_MS);
+    }
+    wifi_conn_set_power_save(false);
+    return true;
+}
+
+// ===== Sample-and-Decide Wakes =====
+
+#if SOIL_WAKE_SAMPLING
+static uint32_t rtc_seconds(void)
+{
+    return (uint32_t)(esp_rtc_get_time_us() / 1000000ULL);
+}
+
+// Radio-less wake: keep the sample, wake the radio only if it matters
+static void finish_sample_wake(const SoilSensorReading *reading)
+{
+    uint64_t sleep_seconds = SOIL_WAKE_SAMPLE_INTERVAL_S;
+
+    if (reading->rawValue != 0)
+    {
+        const soil_wake_policy policy = {SOIL_WAKE_LOW_THRESHOLD_PCT, SOIL_WAKE_HIGH_THRESHOLD_PCT,
+                                         SOIL_WAKE_DELTA_BAND_PCT, app_state()->soil_wake_upload_interval_s};
+        soil_wake_decision decision = soil_wake_evaluate(&policy, &app_state()->soil_wake,
+                                                         (uint8_t)reading->moisturePercent, rtc_seconds());
+
+        Serial.print(F("Sample wake: moisture "));
+        Serial.print(reading->moisturePercent);
+        Serial.print(F("%, decision: "));
+        Serial.println(soil_wake_decision_name(decision));
+
+        if (decision != SOIL_WAKE_SLEEP)
+        {
+            // This wake has no radio: come straight back with the full profile
+            app_state()->soil_wake_report_due = true;
+            sleep_seconds = 1;
+        }
+    }
+
+    board_lifecycle_enter_sleep(sleep_seconds);
+}
+
+// Charging or charged into the surplus band: sample and upload often
+static bool surplus_power(const battery_status *status)
+{
+    sleep_scheduler_battery battery = scheduler_battery(status);
+    return sleep_scheduler_surplus_power(&sleep_policy, &battery);
+}
+
+// Full wake published: re-centre the decision and go back to sampling
+static uint64_t finish_report_wake(const SoilSensorReading *reading, uint64_t upload_interval_s)
+{
+    app_state()->soil_wake_upload_interval_s = (uint32_t)upload_interval_s;
+    app_state()->soil_wake_report_due = false;
+    if (reading->rawValue != 0)
+    {
+        soil_wake_mark_reported(&app_state()->soil_wake, (uint8_t)reading->moisturePercent, rtc_seconds());
+    }
+    return (upload_interval_s < SOIL_WAKE_SAMPLE_INTERVAL_S) ? upload_interval_s : SOIL_WAKE_SAMPLE_INTERVAL_S;
+}
+#endif
+
 // ===== Main Loop =====
 // Loop runs once per wake cycle, then device enters deep sleep
 
 void loop()
 {
-    // Read battery status
-    battery_status status = read_battery_status();
+    // Battery status and soil moisture were read during wakeup
+    battery_status status = battery_reading;
+    SoilSensorReading soilReading = soil_reading;
+
+    if (soilReading.rawValue != 0)
+    {
+        sleep_scheduler_record_moisture(soilReading.moisturePercent);
+    }
+
+    if (board_lifecycle_stage_active(STAGE_BATTERY))
+    {
+        app_state()->has_last_battery = true;
+        app_state()->last_battery = status;
+    }
 
-    // Check battery validity
-    if (!status.is_valid)
+    // Check battery validity (degraded wakes may run without the fuel gauge)
+    if (!board_lifecycle_stage_active(STAGE_BATTERY))
+    {
+        Serial.println(F("Fuel gauge not part of this wake's profile, skipping battery checks"));
+    }
+    else if (!status.is_valid)
     {
         Serial.println("Battery status is INVALID, entering sleep to conserve power...");
         set_status_led(STATUS_BATTERY_INVALID_STATUS);
-        board_lifecycle_enter_sleep(10ULL * 3600); // sleep for 10 hours
+        sleep_in_slot(next_sleep_seconds(&status)); // low battery interval
     }
     else if (status.is_valid && status.is_low_voltage && !status.is_charging)
     {
         Serial.println("Battery voltage is LOW, entering sleep to conserve power...");
         set_status_led(STATUS_BATTERY_CHARGE_LOW);
-        board_lifecycle_enter_sleep(10ULL * 3600); // sleep for 10 hours
+        sleep_in_slot(next_sleep_seconds(&status)); // low battery interval
     }
 
+    if (battery_check_wake)
+    {
+        // The cell recovered (or is charging): come straight back with the regular profile
+        Serial.println(F("Battery check passed, waking again to report"));
+        board_lifecycle_enter_sleep(1ULL);
+    }
+
+#if SOIL_WAKE_SAMPLING
+    if (!board_lifecycle_stage_active(STAGE_MQTT))
+    {
+        finish_sample_wake(&soilReading); // Does not return
+    }
+#endif
+
+    if (!streaming)
+    {
+        subscribe_wake_slot(); // Retained assignment arrives before the wake ends
+        subscribe_broker_time();
+    }
+    publish_boot_guard_incident();
+
     battery_status_to_led(&status);
 
     // Publish battery metrics
@@ -274,32 +1078,64 @@ void loop()
         Serial.println("Battery status is invalid, skipping publish.");
     }
 
-    // Read and publish soil moisture
-    SoilSensorReading soilReading = read_soil_moisture();
-    Serial.print("Soil moisture reading: ");
-    Serial.print(soilReading.rawValue);
-    Serial.print(" (");
-    Serial.print(soilReading.moisturePercent);
-    Serial.println("%)");
+    // Publish soil moisture (sampled during wakeup; degraded wakes may not sample)
+    if (board_lifecycle_stage_active(STAGE_SOIL))
+    {
+        Serial.print("Soil moisture reading: ");
+        Serial.print(soilReading.rawValue);
+        Serial.print(" (");
+        Serial.print(soilReading.moisturePercent);
+        Serial.println("%)");
 
-    char moistureStr[10];
-    snprintf(moistureStr, sizeof(moistureStr), "%d", soilReading.moisturePercent);
-    String topic = get_mqtt_topic(SOIL_SENSOR_PERCENT_MQTT_TOPIC);
-    publish_with_status(topic.c_str(), moistureStr);
+        char moistureStr[10];
+        snprintf(moistureStr, sizeof(moistureStr), "%d", soilReading.moisturePercent);
+        String topic = get_mqtt_topic(SOIL_SENSOR_PERCENT_MQTT_TOPIC);
+        publish_with_status(topic.c_str(), moistureStr);
 
-    char rawStr[10];
-    snprintf(rawStr, sizeof(rawStr), "%d", soilReading.rawValue);
-    topic = get_mqtt_topic(SOIL_SENSOR_RAW_MQTT_TOPIC);
-    publish_with_status(topic.c_str(), rawStr);
+        char rawStr[10];
+        snprintf(rawStr, sizeof(rawStr), "%d", soilReading.rawValue);
+        topic = get_mqtt_topic(SOIL_SENSOR_RAW_MQTT_TOPIC);
+        publish_with_status(topic.c_str(), rawStr);
 
-    Serial.print("Published moisture reading: ");
-    Serial.println(moistureStr);
+        Serial.print("Published moisture reading: ");
+        Serial.println(moistureStr);
+    }
+
+    // Diagnostics describe the wake; streamed readings don't repeat them
+    if (!streaming)
+    {
+        publish_energy_diagnostics();
+        publish_radio_diagnostics();
+        publish_latency_diagnostics();
+        publish_gpio_audit_diagnostics();
+    }
 
     // Success indication
     pulse_status_led(1, STATUS_LED_WHITE);
 
-    // Enter deep sleep
+    if (charging_stream_due(&status) && charging_stream_wait())
+    {
+        // Still connected: take the next reading, the next loop() publishes it
+        streaming = true;
+        wake_start_us = time_keeper_now_us();
+        battery_reading = read_battery_status();
+        if (board_lifecycle_stage_active(STAGE_SOIL))
+        {
+            soil_reading = read_soil_moisture();
+        }
+        return;
+    }
+
+    // Enter deep sleep for as long as soil activity and battery allow
+    uint64_t sleep_seconds = next_sleep_seconds(&status);
+#if SOIL_WAKE_SAMPLING
+    sleep_seconds = finish_report_wake(&soilReading, sleep_seconds);
+    if (surplus_power(&status))
+    {
+        // Surplus power: every wake uploads, not only the ones the soil asks for
+        app_state()->soil_wake_report_due = true;
+    }
+#endif
     Serial.println("Entering sleep...");
-    board_lifecycle_enter_sleep(7ULL * 3600); // sleep for 7 hours
-    // board_lifecycle_enter_sleep(1ULL * 240);
+    sleep_in_slot(sleep_seconds);
 }
@@ -0,0 +1,102 @@
+#ifndef GPIO_AUDIT_CASES_H
+#define GPIO_AUDIT_CASES_H
+
+// Board-independent GPIO audit cases, shared by the per-board test suites.
+// The including suite defines the board (BOARD_TYPE_*, pins) first.
+
+#include <unity.h>
+#include "../lib/PowerMgmt/board_gpio_config.h"
+
+// power_mgmt.cpp needs Arduino, so the native env ignores the PowerMgmt
+// library and the suites build the host-safe audit code directly
+#include "../lib/PowerMgmt/gpio_audit.cpp"
+
+static const gpio_pin_state PIN_PULLED_DOWN = {true, false, false, true, false, false};
+static const gpio_pin_state PIN_FLOATING = {true, false, false, false, false, false};
+static const gpio_pin_state PIN_PULLED_UP = {true, false, true, false, false, true};
+static const gpio_pin_state PIN_DRIVEN = {false, true, false, false, false, false};
+static const gpio_pin_state PIN_HELD_LOW = {true, true, false, false, true, false};
+static const gpio_pin_state PIN_HELD_HIGH = {true, true, false, false, true, true};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_pulldown_expectation(void)
+{
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(GPIO_SLEEP_PULLDOWN, &PIN_PULLED_DOWN));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_PULLDOWN, &PIN_FLOATING));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_PULLDOWN, &PIN_PULLED_UP));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_PULLDOWN, &PIN_DRIVEN));
+}
+
+static void test_held_expectation(void)
+{
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_LOW, &PIN_HELD_LOW));
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_HIGH, &PIN_HELD_HIGH));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_LOW, &PIN_DRIVEN));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_LOW, &PIN_PULLED_DOWN));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_HIGH, &PIN_PULLED_UP));
+}
+
+// Held at the wrong level means the rail was latched ON
+static void test_held_level(void)
+{
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_LOW, &PIN_HELD_HIGH));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(GPIO_SLEEP_HELD_HIGH, &PIN_HELD_LOW));
+}
+
+static void test_unchecked_expectation(void)
+{
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(GPIO_SLEEP_UNCHECKED, &PIN_FLOATING));
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(GPIO_SLEEP_UNCHECKED, &PIN_DRIVEN));
+}
+
+static void test_pack(void)
+{
+    TEST_ASSERT_EQUAL(0x09, gpio_audit_pack(&PIN_PULLED_DOWN));
+    TEST_ASSERT_EQUAL(0x13, gpio_audit_pack(&PIN_HELD_LOW));
+    TEST_ASSERT_EQUAL(0x33, gpio_audit_pack(&PIN_HELD_HIGH));
+}
+
+// Every pin's expectation follows from the descriptor masks
+static void test_expectations_follow_masks(void)
+{
+    for (uint8_t pin = 0; pin < BOARD_GPIO_COUNT; pin++)
+    {
+        uint64_t bit = 1ULL << pin;
+        gpio_sleep_expect expected = (BOARD_GPIO.reserved_mask & bit)    ? GPIO_SLEEP_UNCHECKED
+                                     : (BOARD_GPIO.hold_high_mask & bit) ? GPIO_SLEEP_HELD_HIGH
+                                     : (BOARD_GPIO.hold_mask & bit)      ? GPIO_SLEEP_HELD_LOW
+                                                                         : GPIO_SLEEP_PULLDOWN;
+        TEST_ASSERT_EQUAL(expected, BOARD_GPIO.expected_sleep_state(pin));
+    }
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(BOARD_GPIO_COUNT));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(63));
+}
+
+// Application pins that are not held are pulled down by power management
+static void test_application_pulldown_mask(void)
+{
+    TEST_ASSERT_TRUE((BOARD_GPIO.application_pulldown_mask() & gpio_mask(STATUS_LED_PIN)) != 0);
+    TEST_ASSERT_TRUE((BOARD_GPIO.application_pulldown_mask() & gpio_mask(SOIL_SENSOR_AOUT_PIN)) != 0);
+    TEST_ASSERT_EQUAL(0, BOARD_GPIO.application_pulldown_mask() & BOARD_GPIO.hold_mask);
+}
+
+#define RUN_GPIO_AUDIT_CASES()                    \
+    do                                            \
+    {                                             \
+        RUN_TEST(test_pulldown_expectation);      \
+        RUN_TEST(test_held_expectation);          \
+        RUN_TEST(test_held_level);                \
+        RUN_TEST(test_unchecked_expectation);     \
+        RUN_TEST(test_pack);                      \
+        RUN_TEST(test_expectations_follow_masks); \
+        RUN_TEST(test_application_pulldown_mask); \
+    } while (0)
+
+#endif // GPIO_AUDIT_CASES_H
@@ -0,0 +1,39 @@
+// ESP32-C6 pins, as set by the sparkfun_esp32c6_thing_plus build flags
+#define BOARD_TYPE_ESP32C6 1
+#define STATUS_LED_PIN 23
+#define PERIPHERAL_POWER_PIN 15
+#define BOARD_LED_PIN 8
+#define SOIL_SENSOR_VCC_PIN 2
+
+#include "../gpio_audit_cases.h"
+
+static void test_board_pins(void)
+{
+    TEST_ASSERT_EQUAL(31, BOARD_GPIO_COUNT);
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(9));  // Boot strapping
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(24)); // Flash
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_HELD_HIGH, BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(STATUS_LED_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(SOIL_SENSOR_AOUT_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(I2C_SDA_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(UART_TX_PIN));
+}
+
+static void test_board_sleep_states(void)
+{
+    // Inverted rail: OFF is HIGH, so a rail latched LOW is latched ON
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN), &PIN_HELD_HIGH));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN), &PIN_HELD_LOW));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN), &PIN_PULLED_DOWN));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(STATUS_LED_PIN), &PIN_FLOATING));
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(2), &PIN_FLOATING));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_GPIO_AUDIT_CASES();
+    RUN_TEST(test_board_pins);
+    RUN_TEST(test_board_sleep_states);
+    return UNITY_END();
+}
@@ -0,0 +1,40 @@
+// ESP32-S3 pins, as set by the sparkfun_esp32s3_thing_plus build flags
+#define BOARD_TYPE_ESP32S3 1
+#define STATUS_LED_PIN 46
+#define PERIPHERAL_POWER_PIN 45
+#define BOARD_LED_PIN 8
+#define SOIL_SENSOR_VCC_PIN 2
+
+#include "../gpio_audit_cases.h"
+
+static void test_board_pins(void)
+{
+    TEST_ASSERT_EQUAL(49, BOARD_GPIO_COUNT);
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(0));  // Boot strapping
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(30)); // Flash
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_UNCHECKED, BOARD_GPIO.expected_sleep_state(35)); // Octal PSRAM
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_HELD_LOW, BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(STATUS_LED_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(SOIL_SENSOR_AOUT_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(I2C_SCL_PIN));
+    TEST_ASSERT_EQUAL(GPIO_SLEEP_PULLDOWN, BOARD_GPIO.expected_sleep_state(USB_DP_PIN));
+}
+
+static void test_board_sleep_states(void)
+{
+    // Normal rail: OFF is LOW, so a rail latched HIGH is latched ON
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN), &PIN_HELD_LOW));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN), &PIN_HELD_HIGH));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(PERIPHERAL_POWER_PIN), &PIN_DRIVEN));
+    TEST_ASSERT_FALSE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(STATUS_LED_PIN), &PIN_PULLED_UP));
+    TEST_ASSERT_TRUE(gpio_audit_pin_ok(BOARD_GPIO.expected_sleep_state(3), &PIN_DRIVEN));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_GPIO_AUDIT_CASES();
+    RUN_TEST(test_board_pins);
+    RUN_TEST(test_board_sleep_states);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+#include <unity.h>
+#include <string.h>
+#include <soil_wake.h>
+
+static const soil_wake_policy policy = {30, 70, 10, 3600};
+static soil_wake_state state;
+
+void setUp(void)
+{
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void)
+{
+}
+
+// Report at now_s, then feed the same value until the filter window is full
+static void report_at(uint8_t pct, uint32_t now_s)
+{
+    soil_wake_mark_reported(&state, pct, now_s);
+    for (uint8_t i = 1; i < SOIL_WAKE_FILTER_SAMPLES; i++)
+    {
+        soil_wake_evaluate(&policy, &state, pct, now_s);
+    }
+}
+
+static void test_first_sample_reports(void)
+{
+    TEST_ASSERT_EQUAL(SOIL_WAKE_FIRST, soil_wake_evaluate(&policy, &state, 50, 0));
+}
+
+static void test_steady_sample_sleeps(void)
+{
+    report_at(50, 0);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 52, 900));
+}
+
+static void test_threshold_crossing_reports(void)
+{
+    report_at(33, 0);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 28, 900));
+    TEST_ASSERT_EQUAL(SOIL_WAKE_THRESHOLD, soil_wake_evaluate(&policy, &state, 28, 1800));
+}
+
+static void test_delta_band_reports(void)
+{
+    report_at(50, 0);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 61, 900));
+    TEST_ASSERT_EQUAL(SOIL_WAKE_DELTA, soil_wake_evaluate(&policy, &state, 61, 1800));
+}
+
+static void test_delta_band_disabled(void)
+{
+    soil_wake_policy no_delta = policy;
+    no_delta.delta_band_pct = 0;
+    report_at(50, 0);
+    soil_wake_evaluate(&no_delta, &state, 65, 900);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&no_delta, &state, 65, 1800));
+}
+
+static void test_interval_reports(void)
+{
+    report_at(50, 0);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_INTERVAL, soil_wake_evaluate(&policy, &state, 50, 3600));
+}
+
+static void test_interval_survives_clock_wrap(void)
+{
+    report_at(50, 0xFFFFFF00u);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 50, 0x100u));
+    TEST_ASSERT_EQUAL(SOIL_WAKE_INTERVAL, soil_wake_evaluate(&policy, &state, 50, 0xE00u));
+}
+
+static void test_single_spike_is_filtered(void)
+{
+    report_at(50, 0);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 95, 900));
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 50, 1800));
+    TEST_ASSERT_EQUAL(50, state.last_filtered_pct);
+}
+
+static void test_history_is_bounded(void)
+{
+    for (uint8_t i = 0; i < 2 * SOIL_WAKE_HISTORY_SIZE; i++)
+    {
+        soil_wake_evaluate(&policy, &state, i, i);
+    }
+    TEST_ASSERT_EQUAL(SOIL_WAKE_HISTORY_SIZE, state.history_count);
+    TEST_ASSERT_EQUAL(2 * SOIL_WAKE_HISTORY_SIZE - 1, state.history_pct[SOIL_WAKE_HISTORY_SIZE - 1]);
+}
+
+static void test_mark_reported_recentres(void)
+{
+    report_at(50, 0);
+    soil_wake_evaluate(&policy, &state, 61, 900);
+    soil_wake_mark_reported(&state, 61, 1000);
+    TEST_ASSERT_TRUE(state.has_report);
+    TEST_ASSERT_EQUAL(61, state.last_reported_pct);
+    TEST_ASSERT_EQUAL(61, state.history_pct[state.history_count - 1]);
+    TEST_ASSERT_EQUAL(SOIL_WAKE_SLEEP, soil_wake_evaluate(&policy, &state, 61, 1900));
+}
+
+static void test_decision_names(void)
+{
+    TEST_ASSERT_EQUAL_STRING("sleep", soil_wake_decision_name(SOIL_WAKE_SLEEP));
+    TEST_ASSERT_EQUAL_STRING("threshold", soil_wake_decision_name(SOIL_WAKE_THRESHOLD));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_reports);
+    RUN_TEST(test_steady_sample_sleeps);
+    RUN_TEST(test_threshold_crossing_reports);
+    RUN_TEST(test_delta_band_reports);
+    RUN_TEST(test_delta_band_disabled);
+    RUN_TEST(test_interval_reports);
+    RUN_TEST(test_interval_survives_clock_wrap);
+    RUN_TEST(test_single_spike_is_filtered);
+    RUN_TEST(test_history_is_bounded);
+    RUN_TEST(test_mark_reported_recentres);
+    RUN_TEST(test_decision_names);
+    return UNITY_END();
+}